@@ -39,15 +39,17 @@
 
 const unsigned int MAX_SPRITESHEET_SAMPLER_ARRAY = 32;
 
-// How wide the chunk is in blocks
-// Keep this to a power of 2 (2,4,8, etc)
-const unsigned int CHUNK_BLOCK_SIZE = 16;
+// How many bits make up the chunk block size, set with the PHX_CHUNK_BLOCK_BIT_SIZE CMake cache variable
+#ifndef PHX_CHUNK_BLOCK_BIT_SIZE
+#define PHX_CHUNK_BLOCK_BIT_SIZE 4
+#endif
+const unsigned int CHUNK_BLOCK_BIT_SIZE = PHX_CHUNK_BLOCK_BIT_SIZE;
 
-// How many bits make up the chunk block size
-const unsigned int CHUNK_BLOCK_BIT_SIZE = 4;
+// How wide the chunk is in blocks
+const unsigned int CHUNK_BLOCK_SIZE = 1u << CHUNK_BLOCK_BIT_SIZE;
 
 // An AND mask for the size
-const unsigned int CHUNK_BLOCK_BIT_SIZE_MASK = 0b1111;
+const unsigned int CHUNK_BLOCK_BIT_SIZE_MASK = CHUNK_BLOCK_SIZE - 1;
 
 const unsigned int MAX_BLOCKS_PER_CHUNK = CHUNK_BLOCK_SIZE * CHUNK_BLOCK_SIZE * CHUNK_BLOCK_SIZE;
 
@@ -57,7 +59,45 @@ const unsigned int MAX_WORLD_CHUNKS_PER_AXIS = 7;
 // Total chunks in memory at once
 const unsigned int MAX_CHUNKS = MAX_WORLD_CHUNKS_PER_AXIS * MAX_WORLD_CHUNKS_PER_AXIS * MAX_WORLD_CHUNKS_PER_AXIS;
 
-const unsigned int VERTEX_PAGE_SIZE = 24 * 200;
+// Faces are drawn as two triangles sharing the four corners, indexed 0, 1, 2, 2, 3, 0
+const unsigned int VERTICES_PER_FACE = 4;
+const unsigned int INDICES_PER_FACE  = 6;
+
+// A block has at most one face per direction, and coarser levels of detail have fewer cells than blocks, so no page ever
+// holds more faces than this. Sizes the shared quad index buffer.
+const unsigned int MAX_FACES_PER_PAGE = MAX_BLOCKS_PER_CHUNK;
+
+// Vertices shared by every chunk mesh, sub-allocated in ranges sized to each page
+const unsigned int VERTEX_BUFFER_VERTEX_COUNT = 24 * 200 * 1000;
+
+// Vertices chunk meshes may use before the farthest meshes are evicted, at most VERTEX_BUFFER_VERTEX_COUNT
+const unsigned int VERTEX_MEMORY_BUDGET = VERTEX_BUFFER_VERTEX_COUNT;
+
+// Page ranges are rounded up to this, the spare room lets edits add faces without a full remesh
+const unsigned int VERTEX_ALLOCATION_GRANULARITY = VERTICES_PER_FACE * 16;
+
+// A chunk has at most one page per direction, every page gets its own draw and culling record
+const unsigned int TOTAL_VERTEX_PAGE_COUNT = MAX_CHUNKS * 6;
+
+// Bits of the page record flags word that hold the mesh LOD, must match Shaders/_includes/ChunkPositions.glsl
+const unsigned int PAGE_RECORD_LOD_MASK = 0b1111;
+
+// Bits of the page record flags word that hold the Chunk::Face of the page
+const unsigned int PAGE_RECORD_DIRECTION_SHIFT = 4;
+const unsigned int PAGE_RECORD_DIRECTION_MASK  = 0b111;
+
+// Direction of pages holding faces that point every way, past the last Chunk::Face. Must match ChunkPositions.glsl
+const unsigned int PAGE_DIRECTION_ANY = 6;
+
+// Coarsest level of detail, cells at level n are 1 << n blocks wide
+const unsigned int MAX_CHUNK_LOD = 3;
+
+// Must match local_size_x in ViewFrustrumCulling/shader.comp and OcclusionCulling/shader.comp
+const unsigned int CULLING_WORKGROUP_SIZE = 64;
+
+// Must match local_size_x and local_size_y in DepthPyramid/shader.comp
+const unsigned int DEPTH_PYRAMID_WORKGROUP_SIZE = 8;
 
-const unsigned int TOTAL_VERTEX_PAGE_COUNT = 1000;
+// Enough mip levels to reduce a 32768 pixel wide depth buffer down to a single texel
+const unsigned int MAX_DEPTH_PYRAMID_LEVELS = 16;
 
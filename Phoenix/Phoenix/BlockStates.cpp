@@ -0,0 +1,124 @@
+// BSD 3-Clause License
+// 
+// Copyright (c) 2022, Genten Studios
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <Phoenix/BlockStates.hpp>
+
+#include <Phoenix/Mods.hpp>
+
+phx::BlockStateRegistry::BlockStateRegistry(ModHandler* modHandler) : m_modHandler(modHandler)
+{
+	m_blocks       = std::unique_ptr<ChunkBlock[]>(new ChunkBlock[MAX_BLOCK_STATES]);
+	m_isAir        = std::unique_ptr<uint8_t[]>(new uint8_t[MAX_BLOCK_STATES]);
+	m_isOpaque     = std::unique_ptr<uint8_t[]>(new uint8_t[MAX_BLOCK_STATES]);
+	m_faceTextures = std::unique_ptr<uint32_t[]>(new uint32_t[MAX_BLOCK_STATES * 6]);
+
+	// core.unknown is always there to fall back on
+	AddState(ModHandler::GetAirBlock());
+	AddState(ChunkBlock(ModHandler::GetCoreModID(), ModHandler::GetUnknownBlockID(), 0));
+}
+
+void phx::BlockStateRegistry::RegisterModBlocks()
+{
+	std::lock_guard<std::mutex> lock(m_lookupMutex);
+
+	for (uint16_t mod = 0; mod < m_modHandler->GetModCount(); mod++)
+	{
+		const uint16_t blockCount = m_modHandler->GetMod(mod)->blocks.GetBlockCount();
+
+		for (uint16_t block = 0; block < blockCount; block++)
+		{
+			const ChunkBlock chunkBlock(mod, block, 0);
+
+			if (m_stateLookup.find(chunkBlock.id) == m_stateLookup.end())
+				AddState(chunkBlock);
+		}
+	}
+}
+
+void phx::BlockStateRegistry::RefreshTextures()
+{
+	std::lock_guard<std::mutex> lock(m_lookupMutex);
+
+	const uint32_t stateCount = m_stateCount.load(std::memory_order_relaxed);
+
+	for (uint32_t state = 0; state < stateCount; state++)
+	{
+		SetProperties(static_cast<BlockStateID>(state));
+	}
+}
+
+phx::BlockStateID phx::BlockStateRegistry::GetState(ChunkBlock block)
+{
+	std::lock_guard<std::mutex> lock(m_lookupMutex);
+
+	const auto it = m_stateLookup.find(block.id);
+	if (it != m_stateLookup.end())
+		return it->second;
+
+	if (m_stateCount.load(std::memory_order_relaxed) == MAX_BLOCK_STATES)
+		return m_stateLookup[ChunkBlock(ModHandler::GetCoreModID(), ModHandler::GetUnknownBlockID(), 0).id];
+
+	return AddState(block);
+}
+
+uint32_t phx::BlockStateRegistry::GetStateCount() const { return m_stateCount.load(std::memory_order_acquire); }
+
+phx::BlockStateID phx::BlockStateRegistry::AddState(ChunkBlock block)
+{
+	const BlockStateID state = static_cast<BlockStateID>(m_stateCount.load(std::memory_order_relaxed));
+
+	m_blocks[state] = block;
+	SetProperties(state);
+
+	m_stateLookup[block.id] = state;
+
+	// Published last with release, so a reader that acquires the count also sees the properties of every state below it
+	m_stateCount.store(state + 1, std::memory_order_release);
+
+	return state;
+}
+
+void phx::BlockStateRegistry::SetProperties(BlockStateID state)
+{
+	const ChunkBlock block = m_blocks[state];
+
+	// Metadata does not change how a block looks yet, and blocks from mods that are not loaded show as core.unknown
+	const Block* type = m_modHandler->GetBlock(ChunkBlock(block.val.modID, block.val.blockID, 0));
+	if (type == nullptr)
+		type = m_modHandler->GetBlock(ChunkBlock(ModHandler::GetCoreModID(), ModHandler::GetUnknownBlockID(), 0));
+
+	m_isAir[state]    = block == ModHandler::GetAirBlock();
+	m_isOpaque[state] = !m_isAir[state];
+
+	for (int face = 0; face < 6; face++)
+	{
+		m_faceTextures[state * 6 + face] = type->textureIndex;
+	}
+}
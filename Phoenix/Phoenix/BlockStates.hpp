@@ -0,0 +1,106 @@
+// BSD 3-Clause License
+// 
+// Copyright (c) 2022, Genten Studios
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <Phoenix/Blocks.hpp>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace phx
+{
+	class ModHandler;
+
+	// Dense runtime id of a block state, what chunks store in place of a ChunkBlock
+	using BlockStateID = uint16_t;
+
+	// Every distinct (mod, block, metadata) ChunkBlock gets a BlockStateID, and the properties meshing needs are kept in
+	// flat arrays indexed by it. Blocks declared by the loaded mods are registered up front, anything else, like blocks
+	// with metadata or from mods that are not loaded, is added the first time it is seen so it still saves back out as
+	// it was loaded. Ids are only valid for this run, region files keep storing ChunkBlocks.
+	class BlockStateRegistry
+	{
+	public:
+		static const uint32_t MAX_BLOCK_STATES = 1 << 16;
+
+		explicit BlockStateRegistry(ModHandler* modHandler);
+
+		BlockStateRegistry(const BlockStateRegistry&) = delete;
+		BlockStateRegistry& operator=(const BlockStateRegistry&) = delete;
+
+		// core.air, which is always the first state registered
+		static constexpr BlockStateID GetAirState() { return 0; }
+
+		// Adds a state for every block of every loaded mod, call once mods are loaded
+		void RegisterModBlocks();
+
+		// Copies the texture layers of the mod blocks into every state, call after the block textures are loaded
+		void RefreshTextures();
+
+		// Adds a state the first time a ChunkBlock is seen, so may take a lock. Falls back to core.unknown once
+		// MAX_BLOCK_STATES states exist.
+		BlockStateID GetState(ChunkBlock block);
+
+		ChunkBlock GetBlock(BlockStateID state) const { return m_blocks[state]; }
+
+		bool IsAir(BlockStateID state) const { return m_isAir[state] != 0; }
+		bool IsOpaque(BlockStateID state) const { return m_isOpaque[state] != 0; }
+
+		// Texture layer of the state's face pointing in a Chunk::Face direction
+		uint32_t GetFaceTexture(BlockStateID state, int face) const { return m_faceTextures[state * 6 + face]; }
+
+		uint32_t GetStateCount() const;
+
+	private:
+		// Expects the lock to be held
+		BlockStateID AddState(ChunkBlock block);
+
+		void SetProperties(BlockStateID state);
+
+	private:
+		ModHandler* m_modHandler;
+
+		// Sized for MAX_BLOCK_STATES up front, so adding a state never moves what other threads are reading
+		std::unique_ptr<ChunkBlock[]> m_blocks;
+		std::unique_ptr<uint8_t[]>    m_isAir;
+		std::unique_ptr<uint8_t[]>    m_isOpaque;
+		std::unique_ptr<uint32_t[]>   m_faceTextures;
+
+		// Only written under the lock, read without it
+		std::atomic<uint32_t> m_stateCount {0};
+
+		std::mutex                                 m_lookupMutex;
+		std::unordered_map<uint64_t, BlockStateID> m_stateLookup;
+	};
+} // namespace phx
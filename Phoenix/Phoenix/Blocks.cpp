@@ -58,8 +58,11 @@ uint16_t phx::BlockHandler::AddBlock(const std::string& name, const std::string&
 	block.displayName = displayName;
 	block.texture     = texture;
 
-	m_blocks[m_currentLookupIndex] = block;
-	m_blockNameLookup[name]        = m_currentLookupIndex;
+	Block& stored = m_blocks[m_currentLookupIndex];
+	stored        = block;
+
+	// Keyed by the stored copy, the view has to outlive the block passed in
+	m_blockNameLookup[stored.name] = m_currentLookupIndex;
 
 	return m_currentLookupIndex++;
 }
@@ -72,7 +75,7 @@ phx::Block* phx::BlockHandler::GetBlock(uint16_t lookupIndex) const
 	return &m_blocks[lookupIndex];
 }
 
-phx::Block* phx::BlockHandler::GetBlock(const std::string& name) const
+phx::Block* phx::BlockHandler::GetBlock(std::string_view name) const
 {
 	const auto it = m_blockNameLookup.find(name);
 	if (it == m_blockNameLookup.end())
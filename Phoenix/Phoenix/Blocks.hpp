@@ -33,6 +33,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 
 namespace phx
@@ -87,7 +88,7 @@ namespace phx
 		uint16_t AddBlock(const std::string& name, const std::string& displayName, const std::string& texture);
 
 		Block* GetBlock(uint16_t lookupIndex) const;
-		Block* GetBlock(const std::string& name) const;
+		Block* GetBlock(std::string_view name) const;
 
 		uint16_t GetBlockCount() const;
 		Block*   GetBlocks() const;
@@ -96,7 +97,8 @@ namespace phx
 		std::unique_ptr<Block[]> m_blocks;
 		uint16_t                 m_currentLookupIndex = 0;
 
-		std::unordered_map<std::string, uint16_t> m_blockNameLookup;
+		// Keys view the names of the blocks in m_blocks, which never move once added
+		std::unordered_map<std::string_view, uint16_t> m_blockNameLookup;
 	};
 } // namespace phx
 
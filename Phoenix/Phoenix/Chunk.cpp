@@ -32,6 +32,7 @@
 #include <Phoenix/Phoenix.hpp>
 #include <Phoenix/World.hpp>
 #include <Phoenix/Mods.hpp>
+#include <Phoenix/WorldGenerator.hpp>
 
 #include <Renderer/Buffer.hpp>
 #include <Renderer/DeviceMemory.hpp>
@@ -39,6 +40,82 @@
 #include <Globals/Globals.hpp>
 #include <ResourceManager/ResourceManager.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Faster copies into mapped vertex memory where SSE2 is always available
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PHX_STREAMING_STORES
+#endif
+
+// Marks a block that has no face in that direction
+static const std::uint16_t NO_FACE_SLOT = 0xFFFF;
+
+// Face masks of every block during a full remesh, in LinearChunkLayout order
+static thread_local std::uint8_t s_faceMasks[MAX_BLOCKS_PER_CHUNK];
+
+// Meshes are built here and copied out once finished, mapped vertex memory is often write combined or uncached and
+// slow to read back from or write to piece by piece. Kept between meshes so it is only ever grown once per thread.
+static thread_local std::vector<phx::VertexData> s_meshScratch;
+
+// Copies vertices into mapped memory, without pulling the destination into the cache where the CPU supports it
+static void StreamVertices(void* destination, const phx::VertexData* source, std::size_t count)
+{
+	char*       dst  = static_cast<char*>(destination);
+	const char* src  = reinterpret_cast<const char*>(source);
+	std::size_t size = count * sizeof(phx::VertexData);
+
+#ifdef PHX_STREAMING_STORES
+	// Streaming stores need a 16 byte aligned destination, pages are not aligned to a vertex so copy up to it first
+	const std::size_t head = std::min(size, (16 - (reinterpret_cast<std::uintptr_t>(dst) & 15)) & 15);
+
+	std::memcpy(dst, src, head);
+	dst += head;
+	src += head;
+	size -= head;
+
+	for (; size >= 16; size -= 16, dst += 16, src += 16)
+	{
+		_mm_stream_si128(reinterpret_cast<__m128i*>(dst), _mm_loadu_si128(reinterpret_cast<const __m128i*>(src)));
+	}
+
+	// Streamed stores are weakly ordered, they must land before the memory is unmapped
+	_mm_sfence();
+#endif
+
+	std::memcpy(dst, src, size);
+}
+
+static void GrowPageBounds(phx::VertexPage* page, const phx::VertexData* vertices, std::uint32_t count)
+{
+	for (std::uint32_t i = 0; i < count; i++)
+	{
+		page->boundsMin = glm::min(page->boundsMin, vertices[i].position);
+		page->boundsMax = glm::max(page->boundsMax, vertices[i].position);
+	}
+}
+
+// The finest level of detail below full blocks has the most cells, each page has to fit the shared quad indices
+static_assert((CHUNK_BLOCK_SIZE / 2) * (CHUNK_BLOCK_SIZE / 2) * (CHUNK_BLOCK_SIZE / 2) * 6 <= MAX_FACES_PER_PAGE,
+              "Level of detail pages can hold more faces than there are quad indices");
+
+static_assert(MAX_BLOCKS_PER_CHUNK <= NO_FACE_SLOT, "Face slots and pending blocks hold block indices in 16 bits");
+
+static bool IsInsideChunk(int x, int y, int z)
+{
+	// Negative coordinates wrap to large unsigned values
+	return static_cast<unsigned int>(x) < CHUNK_BLOCK_SIZE && static_cast<unsigned int>(y) < CHUNK_BLOCK_SIZE &&
+	       static_cast<unsigned int>(z) < CHUNK_BLOCK_SIZE;
+}
+
+// Slot maps are indexed in LinearChunkLayout order whatever the storage layout
+static std::uint16_t BlockIndex(int x, int y, int z)
+{
+	return static_cast<std::uint16_t>(phx::LinearChunkLayout::Index(x, y, z));
+}
+
 phx::Chunk::Chunk()
 {
 	m_vertexPage = nullptr;
@@ -48,148 +125,110 @@ phx::Chunk::Chunk()
 	Reset();
 }
 
-// Temp mesh
+// Temp mesh, the four corners of each face in Chunk::Face order. Two triangles are drawn from them with the shared
+// 0, 1, 2, 2, 3, 0 quad indices.
 // clang-format off
 const glm::vec3 BLOCK_VERTICES[] = {
-    {1.f, 1.f, 1.f}, // east (right)
-    {1.f, 1.f, 0.f},
-	{1.f, 0.f, 0.f},
+	{1.f, 1.f, 1.f}, // east (right)
+	{1.f, 1.f, 0.f},
 	{1.f, 0.f, 0.f},
 	{1.f, 0.f, 1.f},
-	{1.f, 1.f, 1.f},
 
 	{0.f, 0.f, 0.f}, // west
 	{0.f, 1.f, 0.f},
-    {0.f, 1.f, 1.f}, 
 	{0.f, 1.f, 1.f},
 	{0.f, 0.f, 1.f},
-    {0.f, 0.f, 0.f},
 
-    {1.f, 0.f, 1.f}, // bottom
-    {1.f, 0.f, 0.f},
-	{0.f, 0.f, 0.f},
+	{1.f, 0.f, 1.f}, // bottom
+	{1.f, 0.f, 0.f},
 	{0.f, 0.f, 0.f},
 	{0.f, 0.f, 1.f},
-	{1.f, 0.f, 1.f},
 
-    {0.f, 1.f, 0.f}, // top
-    {1.f, 1.f, 0.f},
-	{1.f, 1.f, 1.f},
+	{0.f, 1.f, 0.f}, // top
+	{1.f, 1.f, 0.f},
 	{1.f, 1.f, 1.f},
 	{0.f, 1.f, 1.f},
-	{0.f, 1.f, 0.f},
-	
-	{0.f, 0.f, 0.f},  // north (front)
+
+	{0.f, 0.f, 0.f}, // north (front)
 	{1.f, 0.f, 0.f},
-    {1.f, 1.f, 0.f},
 	{1.f, 1.f, 0.f},
 	{0.f, 1.f, 0.f},
-    {0.f, 0.f, 0.f},
 
-    {1.f, 1.f, 1.f}, // south
-    {1.f, 0.f, 1.f},
-	{0.f, 0.f, 1.f}, 
+	{1.f, 1.f, 1.f}, // south
+	{1.f, 0.f, 1.f},
 	{0.f, 0.f, 1.f},
 	{0.f, 1.f, 1.f},
-	{1.f, 1.f, 1.f},
 };
 const glm::vec3 BLOCK_NORMALS[] = {
-	
-
-    {1.f, 0.f, 0.f}, // east (right)
-    {1.f, 0.f, 0.f},
-	{1.f, 0.f, 0.f},
+	{1.f, 0.f, 0.f}, // east (right)
 	{1.f, 0.f, 0.f},
 	{1.f, 0.f, 0.f},
 	{1.f, 0.f, 0.f},
 
 	{1.f, 0.f, 0.f}, // west
 	{1.f, 0.f, 0.f},
-    {1.f, 0.f, 0.f}, 
 	{1.f, 0.f, 0.f},
 	{1.f, 0.f, 0.f},
-    {1.f, 0.f, 0.f},
 
-    {0.f, 1.f, 0.f}, // bottom
-    {0.f, 1.f, 0.f},
-	{0.f, 1.f, 0.f},
+	{0.f, 1.f, 0.f}, // bottom
 	{0.f, 1.f, 0.f},
 	{0.f, 1.f, 0.f},
 	{0.f, 1.f, 0.f},
 
-    {0.f, 1.f, 0.f}, // top
-    {0.f, 1.f, 0.f},
-	{0.f, 1.f, 0.f},
+	{0.f, 1.f, 0.f}, // top
 	{0.f, 1.f, 0.f},
 	{0.f, 1.f, 0.f},
 	{0.f, 1.f, 0.f},
-	
-	{0.f, 0.f, 1.f},  // north (front)
+
+	{0.f, 0.f, 1.f}, // north (front)
 	{0.f, 0.f, 1.f},
-    {0.f, 0.f, 1.f},
 	{0.f, 0.f, 1.f},
 	{0.f, 0.f, 1.f},
-    {0.f, 0.f, 1.f},
 
-    {0.f, 0.f, 1.f}, // south
-    {0.f, 0.f, 1.f},
-	{0.f, 0.f, 1.f}, 
+	{0.f, 0.f, 1.f}, // south
 	{0.f, 0.f, 1.f},
 	{0.f, 0.f, 1.f},
 	{0.f, 0.f, 1.f},
 };
 
 static const glm::vec2 BLOCK_UVS[] = {
-
-    {1.f, 0.f},
+	{1.f, 0.f},
 	{0.f, 0.f},
 	{0.f, 1.f},
-	{0.f, 1.f},
 	{1.f, 1.f},
-	{1.f, 0.f},
 
-    {0.f, 0.f},
+	{0.f, 0.f},
 	{0.f, 1.f},
 	{1.f, 1.f},
-	{1.f, 1.f},
 	{1.f, 0.f},
-	{0.f, 0.f},
 
-    {1.f, 1.f},
+	{1.f, 1.f},
 	{1.f, 0.f},
 	{0.f, 0.f},
-	{0.f, 0.f},
 	{0.f, 1.f},
-	{1.f, 1.f},
 
-    {0.f, 1.f},
+	{0.f, 1.f},
 	{1.f, 1.f},
 	{1.f, 0.f},
-	{1.f, 0.f},
 	{0.f, 0.f},
-	{0.f, 1.f},
 
 	{1.f, 1.f},
 	{0.f, 1.f},
 	{0.f, 0.f},
-	{0.f, 0.f},
 	{1.f, 0.f},
-    {1.f, 1.f},
-	
+
 	{1.f, 0.f},
 	{1.f, 1.f},
 	{0.f, 1.f},
-	{0.f, 1.f},
 	{0.f, 0.f},
-    {1.f, 0.f},
 };
 // clang-format on
 
-void phx::Chunk::Initialize(World* world, Buffer* vertexBuffer, ModHandler* modHandler)
+void phx::Chunk::Initialize(World* world, Buffer* vertexBuffer, BlockStateRegistry* blockStates)
 {
 	m_vertexBuffer = vertexBuffer;
 	m_world = world;
-	m_modHandler   = modHandler;
+	m_blockStates  = blockStates;
 }
 
 void phx::Chunk::SetPosition(glm::ivec3 position)
@@ -197,76 +236,279 @@ void phx::Chunk::SetPosition(glm::ivec3 position)
 	m_position = position;
 }
 
-void phx::Chunk::SetRenderPosition(glm::vec3 position)
+void phx::Chunk::Reset()
 {
-	m_matrix = glm::mat4(1.0f);
-	m_matrix = glm::translate(m_matrix, position);
+	for (BlockStateID& state : m_blocks)
+	{
+		state = BlockStateRegistry::GetAirState();
+	}
+
+	m_solidCount = 0;
+
+	for (int j = 0; j < 6; j++)
+	{
+		m_borderSolidCount[j] = 0;
+	}
 }
 
-void phx::Chunk::Reset()
+void phx::Chunk::GenerateWorld(WorldGenerator* generator)
+{
+	// Generators fill linear order, reordered into storage on the way in
+	static thread_local ChunkBlock generated[MAX_BLOCKS_PER_CHUNK];
+
+	generator->Generate(m_position >> static_cast<int>(CHUNK_BLOCK_BIT_SIZE), generated);
+	WriteBlocks(generated);
+
+	m_dirty = true;
+}
+
+bool phx::Chunk::Update()
+{
+	// The blocks may have changed while evicted, so the mesh always comes back through a full remesh
+	if (m_evicted)
+	{
+		if (!m_world->CanAdmitMesh(this, m_evictedVertexCount))
+			return false;
+
+		m_evicted = false;
+		m_dirty   = true;
+	}
+
+	if (m_dirty)
+	{
+		GenerateMesh();
+		m_dirty = false;
+		return true;
+	}
+
+	if (m_pendingBlockCount > 0)
+	{
+		PatchMesh();
+	}
+
+	return false;
+}
+
+unsigned int phx::Chunk::GetTotalVertexCount() { return m_totalVertexCount; }
+
+void phx::Chunk::SetNeighbouringChunk(ChunkNeighbours* neighbouringChunk) { m_neighbouringChunk = neighbouringChunk; }
+
+phx::ChunkBlock phx::Chunk::GetBlock(int x, int y, int z) { return m_blockStates->GetBlock(BlockAt(x, y, z)); }
+
+void phx::Chunk::SetBlock(int x, int y, int z, ChunkBlock block) { SetBlockState(x, y, z, m_blockStates->GetState(block)); }
+
+void phx::Chunk::SetBlockState(int x, int y, int z, BlockStateID state)
+{
+	BlockStateID& stored = BlockAt(x, y, z);
+
+	UpdateSummary(x, y, z, m_blockStates->IsOpaque(stored), m_blockStates->IsOpaque(state));
+
+	stored     = state;
+	m_modified = true;
+
+	// Faces of the block and of the blocks around it may have been exposed or hidden. Across the chunk border the
+	// neighbouring chunk has to be told by whoever made the edit.
+	MarkBlockDirty(x, y, z);
+
+	for (const int(&offset)[3] : ChunkSize::FACE_OFFSETS)
+	{
+		const int nx = x + offset[0];
+		const int ny = y + offset[1];
+		const int nz = z + offset[2];
+
+		if (IsInsideChunk(nx, ny, nz))
+			MarkBlockDirty(nx, ny, nz);
+	}
+}
+
+void phx::Chunk::ReadBlocks(ChunkBlock* blocks) const
+{
+	ForEachBlock([this, blocks](int x, int y, int z, BlockStateID state) {
+		blocks[LinearChunkLayout::Index(x, y, z)] = m_blockStates->GetBlock(state);
+	});
+}
+
+void phx::Chunk::WriteBlocks(const ChunkBlock* blocks)
 {
-	// Temp random blocks
-	for (int k = 0; k < CHUNK_BLOCK_SIZE; ++k)
+	// Chunks are mostly long runs of a few kinds of block, so most lookups are the same as the last one
+	ChunkBlock   lastBlock = ModHandler::GetAirBlock();
+	BlockStateID lastState = BlockStateRegistry::GetAirState();
+
+	for (std::uint32_t i = 0; i < MAX_BLOCKS_PER_CHUNK; i++)
 	{
-		for (int j = 0; j < CHUNK_BLOCK_SIZE; ++j)
+		const glm::ivec3 position = ChunkLayout::Position(i);
+		const ChunkBlock block    = blocks[LinearChunkLayout::Index(position.x, position.y, position.z)];
+
+		if (block != lastBlock)
 		{
-			for (int i = 0; i < CHUNK_BLOCK_SIZE; ++i)
-			{
-				m_blocks[i][j][k] = ModHandler::GetAirBlock();
-			}
+			lastBlock = block;
+			lastState = m_blockStates->GetState(block);
 		}
+
+		m_blocks[i] = lastState;
 	}
+
+	RebuildSummary();
 }
 
-void phx::Chunk::GenerateWorld()
+bool phx::Chunk::IsModified() { return m_modified; }
+
+void phx::Chunk::ClearModified() { m_modified = false; }
+
+void phx::Chunk::RebuildSummary()
 {
+	m_solidCount = 0;
 
-	for (int z = 0; z < CHUNK_BLOCK_SIZE; ++z)
+	for (int j = 0; j < 6; j++)
 	{
-		for (int y = 0; y < CHUNK_BLOCK_SIZE; ++y)
-		{
-			for (int x = 0; x < CHUNK_BLOCK_SIZE; ++x)
-			{
-				float ya = (float) y + m_position.y;
-	
-				bool solid = ya < -5;
+		m_borderSolidCount[j] = 0;
+	}
+
+	ForEachBlock([this](int x, int y, int z, BlockStateID state) {
+		UpdateSummary(x, y, z, false, m_blockStates->IsOpaque(state));
+	});
+}
+
+void phx::Chunk::UpdateSummary(int x, int y, int z, bool wasSolid, bool isSolid)
+{
+	if (wasSolid == isSolid)
+		return;
 
-				// hard coded blocks.
-				constexpr ChunkBlock dirt  = {0x00000001};
-				constexpr ChunkBlock stone = {0x00010001};
+	const int change = isSolid ? 1 : -1;
+
+	m_solidCount += change;
+
+	// Sides match the neighbour lookups in ComputeFaceMask, Top is towards -y
+	if (x == CHUNK_BLOCK_SIZE - 1)
+		m_borderSolidCount[East] += change;
+	if (x == 0)
+		m_borderSolidCount[West] += change;
+	if (y == 0)
+		m_borderSolidCount[Top] += change;
+	if (y == CHUNK_BLOCK_SIZE - 1)
+		m_borderSolidCount[Bottom] += change;
+	if (z == 0)
+		m_borderSolidCount[North] += change;
+	if (z == CHUNK_BLOCK_SIZE - 1)
+		m_borderSolidCount[South] += change;
+}
 
-				m_blocks[x][y][z] = solid ? dirt : ModHandler::GetAirBlock();
+bool phx::Chunk::IsBorderOpaque(Face face) { return m_borderSolidCount[face] == CHUNK_BLOCK_SIZE * CHUNK_BLOCK_SIZE; }
 
-			}
-		}
+bool phx::Chunk::IsEnclosed()
+{
+	if (m_solidCount != MAX_BLOCKS_PER_CHUNK || m_neighbouringChunk == nullptr)
+		return false;
+
+	for (int j = 0; j < 6; j++)
+	{
+		Chunk** neighbour = m_neighbouringChunk->neighbouringChunks[j];
+
+		// Faces on the edge of the world are never meshed, the same as in ComputeFaceMask. Faces come in opposing
+		// pairs, so j ^ 1 is the neighbour's side that touches this chunk.
+		if (neighbour != nullptr && !(*neighbour)->IsBorderOpaque(static_cast<Face>(j ^ 1)))
+			return false;
 	}
 
+	return true;
+}
+
+void phx::Chunk::MarkBlockDirty(int x, int y, int z)
+{
+	// A full remesh is already on its way, or will be once an evicted mesh comes back
+	if (m_dirty || m_evicted)
+		return;
+
+	// Either empty or enclosed last time, a block next to it changed so that may no longer hold
+	if (m_meshSkipped)
+	{
+		m_dirty = true;
+		return;
+	}
+
+	// Only full detail meshes keep the slot maps needed for patching, coarser levels are cheap to rebuild
+	if (m_lod > 0)
+	{
+		m_dirty = true;
+		return;
+	}
+
+	const std::uint16_t blockIndex = BlockIndex(x, y, z);
+
+	for (std::uint32_t i = 0; i < m_pendingBlockCount; i++)
+	{
+		if (m_pendingBlocks[i] == blockIndex)
+			return;
+	}
 
+	// Past this many blocks rebuilding the chunk is cheaper than patching it
+	if (m_pendingBlockCount == MAX_PENDING_BLOCKS)
+	{
+		m_dirty = true;
+		return;
+	}
+
+	m_pendingBlocks[m_pendingBlockCount++] = blockIndex;
+}
+
+void phx::Chunk::MarkDirty() { m_dirty = true; }
+
+void phx::Chunk::ReleaseMesh()
+{
+	FreeMesh();
 	m_dirty = true;
 }
 
-void phx::Chunk::Update()
+void phx::Chunk::EvictMesh()
 {
-	if (m_dirty)
+	m_evictedVertexCount = m_totalVertexCount;
+	m_evicted            = true;
+
+	FreeMesh();
+	ReleaseSlotMemory();
+}
+
+bool phx::Chunk::IsEvicted() const { return m_evicted; }
+
+bool phx::Chunk::HasMesh() const { return m_vertexPage != nullptr; }
+
+void phx::Chunk::FreeMesh()
+{
+	m_world->FreeVertexPages(m_vertexPage);
+	m_vertexPage = nullptr;
+
+	for (int j = 0; j < 6; j++)
 	{
-		GenerateMesh();
-		m_dirty = false;
+		m_directionPages[j] = nullptr;
 	}
-}
 
-unsigned int phx::Chunk::GetTotalVertexCount() { return m_totalVertexCount; }
+	for (std::vector<std::uint16_t>& slotBlock : m_slotBlock)
+	{
+		slotBlock.clear();
+	}
 
-void phx::Chunk::SetNeighbouringChunk(ChunkNeighbours* neighbouringChunk) { m_neighbouringChunk = neighbouringChunk; }
+	m_faceSlot.reset();
 
-phx::ChunkBlock phx::Chunk::GetBlock(int x, int y, int z) { return m_blocks[x][y][z]; }
+	m_totalVertexCount  = 0;
+	m_pendingBlockCount = 0;
+}
 
-void phx::Chunk::SetBlock(int x, int y, int z, ChunkBlock block)
+void phx::Chunk::ReleaseSlotMemory()
 {
-	m_blocks[x][y][z] = block;
-	m_dirty           = true;
+	for (std::vector<std::uint16_t>& slotBlock : m_slotBlock)
+	{
+		slotBlock.shrink_to_fit();
+	}
 }
 
-void phx::Chunk::MarkDirty() { m_dirty = true; }
+void phx::Chunk::OnOutOfVertexMemory(std::uint32_t vertexCount)
+{
+	FreeMesh();
+	ReleaseSlotMemory();
+
+	m_evicted            = true;
+	m_evictedVertexCount = vertexCount;
+}
 
 glm::ivec3 phx::Chunk::GetPosition() { return m_position; }
 
@@ -274,198 +516,494 @@ phx::ChunkNeighbours* phx::Chunk::GetNabours() { return m_neighbouringChunk; }
 
 void phx::Chunk::GenerateMesh()
 {
-	int totalVertexCount = 0;
+	// Everything is rebuilt, so anything waiting to be patched is covered too
+	FreeMesh();
 
-	void*       memoryPtr    = nullptr;
-	VertexData* vertexStream = nullptr;
+	// Nothing can be seen of an empty chunk or of one walled in on every side, so skip walking its blocks at all.
+	// A change to it or to a neighbour's border brings it back through MarkBlockDirty.
+	m_meshSkipped = m_solidCount == 0 || IsEnclosed();
 
-	m_world->FreeVertexPages(m_vertexPage);
-	m_vertexPage = nullptr;
+	if (m_meshSkipped)
+		return;
+
+	if (m_lod > 0)
+	{
+		GenerateLODMesh();
+		return;
+	}
 
 	if (m_neighbouringChunk == nullptr)
 		return;
 
-	for (int x = 0; x < CHUNK_BLOCK_SIZE; ++x)
+	std::uint32_t totalFaces = 0;
+
+	// Storage order keeps the neighbour reads of each block close together
+	ForEachBlock([this, &totalFaces](int x, int y, int z, BlockStateID) {
+		const std::uint8_t faceMask = ComputeFaceMask(x, y, z);
+
+		s_faceMasks[BlockIndex(x, y, z)] = faceMask;
+
+		for (int j = 0; j < 6; j++)
+		{
+			totalFaces += (faceMask >> j) & 1;
+		}
+	});
+
+	if (s_meshScratch.size() < totalFaces * VERTICES_PER_FACE)
+		s_meshScratch.resize(totalFaces * VERTICES_PER_FACE);
+
+	VertexData* vertexStream = s_meshScratch.data();
+
+	// Faces are emitted one direction at a time so every page only holds faces that point the same way,
+	// that lets the culling shader drop whole pages that face away from the camera
+	for (int j = 0; j < 6; j++)
 	{
-		for (int y = 0; y < CHUNK_BLOCK_SIZE; ++y)
+		for (int x = 0; x < CHUNK_BLOCK_SIZE; ++x)
 		{
-			for (int z = 0; z < CHUNK_BLOCK_SIZE; ++z)
+			for (int y = 0; y < CHUNK_BLOCK_SIZE; ++y)
 			{
-				// Check if we are about to render air
-				ChunkBlock blockID = m_blocks[x][y][z];
-				if (blockID == ModHandler::GetAirBlock())
-					continue;
-		
-				bool visibilitySet[6] = {false, false, false, false, false, false};
-
-				// East
-				if (x == CHUNK_BLOCK_SIZE - 1)
-				{
-					Chunk** neighbor = m_neighbouringChunk->neighbouringChunks[Chunk::East];
-					if (neighbor != nullptr)
-					{
-						visibilitySet[Chunk::East] = (*neighbor)->m_blocks[0][y][z] == ModHandler::GetAirBlock();
-					}
-				}
-				else
-				{
-					visibilitySet[Chunk::East] = (m_blocks[x + 1][y][z] == ModHandler::GetAirBlock());
-				}
-				
-				// West
-				if (x == 0)
-				{
-					Chunk** neighbor = m_neighbouringChunk->neighbouringChunks[Chunk::West];
-					if (neighbor != nullptr)
-					{
-						visibilitySet[Chunk::West] = (*neighbor)->m_blocks[CHUNK_BLOCK_SIZE - 1][y][z] == ModHandler::GetAirBlock();
-					}
-				}
-				else
-				{
-					visibilitySet[Chunk::West] = (m_blocks[x - 1][y][z] == ModHandler::GetAirBlock());
-				}
-				
-				// Top
-				if (y == 0)
-				{
-					Chunk** neighbor = m_neighbouringChunk->neighbouringChunks[Chunk::Top];
-					if (neighbor != nullptr)
-					{
-						visibilitySet[Chunk::Top] = (*neighbor)->m_blocks[x][CHUNK_BLOCK_SIZE - 1][z] == ModHandler::GetAirBlock();
-					}
-				}
-				else
-				{
-					visibilitySet[Chunk::Top] = (m_blocks[x][y - 1][z] == ModHandler::GetAirBlock());
-				}
-				
-				// Bottom
-				if (y == CHUNK_BLOCK_SIZE - 1)
+				for (int z = 0; z < CHUNK_BLOCK_SIZE; ++z)
 				{
-					Chunk** neighbor = m_neighbouringChunk->neighbouringChunks[Chunk::Bottom];
-					if (neighbor != nullptr)
-					{
-						visibilitySet[Chunk::Bottom] = (*neighbor)->m_blocks[x][0][z] == ModHandler::GetAirBlock();
-					}
-				}
-				else
-				{
-					visibilitySet[Chunk::Bottom] = (m_blocks[x][y + 1][z] == ModHandler::GetAirBlock());
-				}
-				
-				
-				// North
-				if (z == 0)
-				{
-					Chunk** neighbor = m_neighbouringChunk->neighbouringChunks[Chunk::North];
-					if (neighbor != nullptr)
-					{
-						visibilitySet[Chunk::North] = (*neighbor)->m_blocks[x][y][CHUNK_BLOCK_SIZE - 1] == ModHandler::GetAirBlock();
-					}
-				}
-				else
-				{
-					visibilitySet[Chunk::North] = (m_blocks[x][y][z - 1] == ModHandler::GetAirBlock());
+					const std::uint16_t blockIndex = BlockIndex(x, y, z);
+
+					if ((s_faceMasks[blockIndex] & (1 << j)) == 0)
+						continue;
+
+					m_slotBlock[j].push_back(blockIndex);
+
+					WriteFace(vertexStream, glm::ivec3(x, y, z), 1, j, BlockAt(x, y, z));
+
+					vertexStream += VERTICES_PER_FACE;
 				}
-				
-				
-				// South
-				if (z == CHUNK_BLOCK_SIZE - 1)
+			}
+		}
+	}
+
+	// Only now are the face counts known, so every direction gets a page sized to its faces
+	void* memoryPtr = nullptr;
+	m_vertexBuffer->GetDeviceMemory()->Map(m_vertexBuffer->GetBufferSize(), m_vertexBuffer->GetMemoryOffset(), memoryPtr);
+
+	const VertexData* directionVertices = s_meshScratch.data();
+
+	for (int j = 0; j < 6; j++)
+	{
+		const std::uint32_t faceCount = static_cast<std::uint32_t>(m_slotBlock[j].size());
+
+		if (faceCount == 0)
+			continue;
+
+		VertexPage* page = AllocateDirectionPage(j, faceCount * VERTICES_PER_FACE);
+
+		if (page == nullptr)
+		{
+			m_vertexBuffer->GetDeviceMemory()->Unmap();
+			OnOutOfVertexMemory(totalFaces * VERTICES_PER_FACE);
+			return;
+		}
+
+		page->vertexCount = faceCount * VERTICES_PER_FACE;
+
+		UploadVertices(memoryPtr, page, directionVertices);
+
+		directionVertices += page->vertexCount;
+	}
+
+	m_vertexBuffer->GetDeviceMemory()->Unmap();
+
+	m_totalVertexCount = totalFaces * VERTICES_PER_FACE;
+
+	m_world->ProcessVertexPages(m_vertexPage, m_position);
+}
+
+void phx::Chunk::GenerateLODMesh()
+{
+	const int cellSize  = 1 << m_lod;
+	const int cellCount = CHUNK_BLOCK_SIZE >> m_lod;
+
+	// Level 1 has the most cells
+	BlockStateID cells[CHUNK_BLOCK_SIZE / 2][CHUNK_BLOCK_SIZE / 2][CHUNK_BLOCK_SIZE / 2];
+
+	for (int x = 0; x < cellCount; ++x)
+	{
+		for (int y = 0; y < cellCount; ++y)
+		{
+			for (int z = 0; z < cellCount; ++z)
+			{
+				cells[x][y][z] = DownsampleCell(x * cellSize, y * cellSize, z * cellSize, cellSize);
+			}
+		}
+	}
+
+	// Every cell showing all six faces is the most there can be
+	const std::size_t maxVertices = static_cast<std::size_t>(cellCount * cellCount * cellCount) * 6 * VERTICES_PER_FACE;
+
+	if (s_meshScratch.size() < maxVertices)
+		s_meshScratch.resize(maxVertices);
+
+	VertexData* vertexStream = s_meshScratch.data();
+
+	for (int x = 0; x < cellCount; ++x)
+	{
+		for (int y = 0; y < cellCount; ++y)
+		{
+			for (int z = 0; z < cellCount; ++z)
+			{
+				if (!m_blockStates->IsOpaque(cells[x][y][z]))
+					continue;
+
+				// Same face order as Chunk::Face, neighbours outside of the chunk count as air
+				const glm::ivec3 neighbours[6] = {{x + 1, y, z}, {x - 1, y, z}, {x, y - 1, z},
+				                                  {x, y + 1, z}, {x, y, z - 1}, {x, y, z + 1}};
+
+				for (int j = 0; j < 6; j++)
 				{
-					Chunk** neighbor = m_neighbouringChunk->neighbouringChunks[Chunk::South];
-					if (neighbor != nullptr)
-					{
-						visibilitySet[Chunk::South] = (*neighbor)->m_blocks[x][y][0] == ModHandler::GetAirBlock();
-					}
+					const glm::ivec3& n = neighbours[j];
+
+					// Faces on the chunk border are always kept. Neighbouring chunks may be at a different level, the
+					// walls hang over the gaps where the two surfaces do not line up.
+					const bool onBorder = glm::any(glm::lessThan(n, glm::ivec3(0))) ||
+					                      glm::any(glm::greaterThanEqual(n, glm::ivec3(cellCount)));
+
+					if (!onBorder && m_blockStates->IsOpaque(cells[n.x][n.y][n.z]))
+						continue;
+
+					WriteFace(vertexStream, glm::ivec3(x, y, z) * cellSize, cellSize, j, cells[x][y][z]);
+
+					vertexStream += VERTICES_PER_FACE;
 				}
-				else
+			}
+		}
+	}
+
+	m_totalVertexCount = static_cast<unsigned int>(vertexStream - s_meshScratch.data());
+
+	if (m_totalVertexCount == 0)
+		return;
+
+	// Distant chunks are small enough on screen that one page for every direction beats six mostly empty ones, so the
+	// page is marked as facing every way and never culled by direction
+	VertexPage* page = m_world->AllocateVertexPage(m_totalVertexCount, this);
+
+	if (page == nullptr)
+	{
+		OnOutOfVertexMemory(m_totalVertexCount);
+		return;
+	}
+
+	page->direction   = PAGE_DIRECTION_ANY;
+	page->lod         = m_lod;
+	page->vertexCount = m_totalVertexCount;
+	page->next        = m_vertexPage;
+	m_vertexPage      = page;
+
+	void* memoryPtr = nullptr;
+	m_vertexBuffer->GetDeviceMemory()->Map(m_vertexBuffer->GetBufferSize(), m_vertexBuffer->GetMemoryOffset(), memoryPtr);
+
+	UploadVertices(memoryPtr, page, s_meshScratch.data());
+
+	m_vertexBuffer->GetDeviceMemory()->Unmap();
+
+	m_world->ProcessVertexPages(m_vertexPage, m_position);
+}
+
+phx::BlockStateID phx::Chunk::DownsampleCell(int originX, int originY, int originZ, int cellSize)
+{
+	// The cell is solid when at least half of its blocks are, and takes the most common solid block
+	const int maxCandidates = 8;
+
+	BlockStateID candidates[maxCandidates];
+	int          votes[maxCandidates] = {};
+	int          candidateCount       = 0;
+	int          solidCount           = 0;
+
+	for (int x = originX; x < originX + cellSize; ++x)
+	{
+		for (int y = originY; y < originY + cellSize; ++y)
+		{
+			for (int z = originZ; z < originZ + cellSize; ++z)
+			{
+				const BlockStateID block = BlockAt(x, y, z);
+
+				if (!m_blockStates->IsOpaque(block))
+					continue;
+
+				solidCount++;
+
+				int candidate = 0;
+				while (candidate < candidateCount && candidates[candidate] != block)
+					candidate++;
+
+				// Rare blocks past the first few kinds in the cell are outvoted anyway
+				if (candidate == candidateCount)
 				{
-					visibilitySet[Chunk::South] = (m_blocks[x][y][z + 1] == ModHandler::GetAirBlock());
+					if (candidateCount == maxCandidates)
+						continue;
+
+					candidates[candidateCount++] = block;
 				}
 
+				votes[candidate]++;
+			}
+		}
+	}
 
-				// Loop through for all faces of the block
-				for (int j = 0; j < 6; j++)
-				{
-					if (visibilitySet[j])
-					{
-						if (m_vertexPage == nullptr)
-						{
-							// Allocate the first page
+	if (solidCount * 2 < cellSize * cellSize * cellSize)
+		return BlockStateRegistry::GetAirState();
 
-							m_vertexPage = m_world->GetFreeVertexPage();
+	int winner = 0;
+	for (int candidate = 1; candidate < candidateCount; candidate++)
+	{
+		if (votes[candidate] > votes[winner])
+			winner = candidate;
+	}
 
-							if (m_vertexPage == nullptr)
-							{
-								assert(0 && "To do, no more pages");
-								return;
-							}
+	return candidates[winner];
+}
 
-							m_vertexBuffer->GetDeviceMemory()->Map(VERTEX_PAGE_SIZE * sizeof(VertexData),
-							                                       m_vertexBuffer->GetMemoryOffset() + m_vertexPage->offset, memoryPtr);
+void phx::Chunk::SetLOD(std::uint32_t lod)
+{
+	if (lod == m_lod)
+		return;
 
-							vertexStream = reinterpret_cast<VertexData*>(memoryPtr);
-						}
-						else if (VERTEX_PAGE_SIZE - m_vertexPage->vertexCount < 36)
-						{
-							// Move onto a new page
+	m_lod   = lod;
+	m_dirty = true;
+}
 
-							m_vertexBuffer->GetDeviceMemory()->Unmap();
+std::uint32_t phx::Chunk::GetLOD() { return m_lod; }
 
-							VertexPage* newPage = m_world->GetFreeVertexPage();
+void phx::Chunk::PatchMesh()
+{
+	// Bit j is set when the page of direction j changed
+	std::uint8_t touchedPages = 0;
 
-							if (newPage == nullptr)
-							{
-								assert(0 && "To do, no more pages");
-								return;
-							}
+	if (!m_faceSlot)
+		BuildFaceSlots();
 
-							m_vertexBuffer->GetDeviceMemory()->Map(VERTEX_PAGE_SIZE * sizeof(VertexData),
-							                                       m_vertexBuffer->GetMemoryOffset() + newPage->offset, memoryPtr);
+	for (std::uint32_t i = 0; i < m_pendingBlockCount; i++)
+	{
+		const std::uint16_t blockIndex = m_pendingBlocks[i];
 
-							newPage->next = m_vertexPage;
-							m_vertexPage  = newPage;
+		PatchBlockFaces(blockIndex >> (CHUNK_BLOCK_BIT_SIZE * 2), (blockIndex >> CHUNK_BLOCK_BIT_SIZE) & CHUNK_BLOCK_BIT_SIZE_MASK,
+		                blockIndex & CHUNK_BLOCK_BIT_SIZE_MASK, touchedPages);
 
-							vertexStream = reinterpret_cast<VertexData*>(memoryPtr);
-						}
+		// A page ran out of room part way through, the full remesh on the next update sizes it again
+		if (m_dirty)
+			return;
+	}
 
-						// Temp texture solution
-						int faceTextureID = m_modHandler->GetBlock(blockID)->textureIndex;
-						// Loop through for the face vertices
-						for (int k = 0; k < 6; k++)
-						{
-							unsigned int lookupIndex = k + (j * 6);
+	m_pendingBlockCount = 0;
+	m_totalVertexCount  = 0;
 
-							(*vertexStream).position = BLOCK_VERTICES[lookupIndex];
-							(*vertexStream).position.x += x;
-							(*vertexStream).position.y += y;
-							(*vertexStream).position.z += z;
+	for (int j = 0; j < 6; j++)
+	{
+		const std::uint32_t faceCount = static_cast<std::uint32_t>(m_slotBlock[j].size());
 
-							(*vertexStream).normal = BLOCK_NORMALS[lookupIndex];							
+		m_totalVertexCount += faceCount * VERTICES_PER_FACE;
 
-							(*vertexStream).uv = BLOCK_UVS[lookupIndex];
+		if ((touchedPages & (1 << j)) == 0)
+			continue;
 
-							(*vertexStream).textureID = faceTextureID;
+		// Faces stay packed from slot 0, an emptied page is kept with nothing to draw in case faces come back
+		VertexPage* page  = m_directionPages[j];
+		page->vertexCount = faceCount * VERTICES_PER_FACE;
 
-							vertexStream++;
-						}
+		m_world->ProcessVertexPage(page, m_position);
+	}
+}
 
-						m_vertexPage->vertexCount += 6;
-						totalVertexCount += 6;
-					}
-				}
+std::uint8_t phx::Chunk::ComputeFaceMask(int x, int y, int z)
+{
+	// Check if we are about to render air
+	if (!IsOpaqueAt(x, y, z))
+		return 0;
+
+	std::uint8_t faceMask = 0;
+
+	for (int j = 0; j < 6; j++)
+	{
+		const int nx = x + ChunkSize::FACE_OFFSETS[j][0];
+		const int ny = y + ChunkSize::FACE_OFFSETS[j][1];
+		const int nz = z + ChunkSize::FACE_OFFSETS[j][2];
+
+		bool visible = false;
+
+		if (IsInsideChunk(nx, ny, nz))
+		{
+			visible = !IsOpaqueAt(nx, ny, nz);
+		}
+		else
+		{
+			// Past the border the coordinate wraps around to the far side of the neighbouring chunk
+			Chunk** neighbor = m_neighbouringChunk->neighbouringChunks[j];
+			if (neighbor != nullptr)
+			{
+				visible = !(*neighbor)->IsOpaqueAt(nx & ChunkSize::MASK, ny & ChunkSize::MASK, nz & ChunkSize::MASK);
 			}
 		}
+
+		if (visible)
+			faceMask |= 1 << j;
+	}
+
+	return faceMask;
+}
+
+void phx::Chunk::PatchBlockFaces(int x, int y, int z, std::uint8_t& touchedPages)
+{
+	const std::uint8_t  faceMask   = ComputeFaceMask(x, y, z);
+	const std::uint16_t blockIndex = BlockIndex(x, y, z);
+
+	for (int j = 0; j < 6; j++)
+	{
+		const bool wasVisible = FaceSlot(j, blockIndex) != NO_FACE_SLOT;
+		const bool isVisible  = (faceMask & (1 << j)) != 0;
+
+		if (wasVisible && !isVisible)
+		{
+			RemoveFace(j, blockIndex, touchedPages);
+		}
+		else if (!wasVisible && isVisible)
+		{
+			if (!AddFace(j, blockIndex, touchedPages))
+				return;
+		}
+		else if (isVisible)
+		{
+			// The block may have been swapped for another solid one, so its faces are rewritten for the new texture
+			WriteFaceToSlot(j, FaceSlot(j, blockIndex), blockIndex, touchedPages);
+		}
+	}
+}
+
+void phx::Chunk::BuildFaceSlots()
+{
+	m_faceSlot = std::unique_ptr<std::uint16_t[]>(new std::uint16_t[6 * MAX_BLOCKS_PER_CHUNK]);
+
+	std::fill(m_faceSlot.get(), m_faceSlot.get() + 6 * MAX_BLOCKS_PER_CHUNK, NO_FACE_SLOT);
+
+	for (int j = 0; j < 6; j++)
+	{
+		for (std::uint32_t slot = 0; slot < m_slotBlock[j].size(); slot++)
+		{
+			FaceSlot(j, m_slotBlock[j][slot]) = static_cast<std::uint16_t>(slot);
+		}
 	}
+}
+
+bool phx::Chunk::AddFace(int direction, std::uint16_t blockIndex, std::uint8_t& touchedPages)
+{
+	const std::uint32_t slot = static_cast<std::uint32_t>(m_slotBlock[direction].size());
+
+	VertexPage* page = m_directionPages[direction];
 
-	m_totalVertexCount = totalVertexCount;
+	if (page == nullptr)
+		page = AllocateDirectionPage(direction, VERTICES_PER_FACE);
 
-	if (m_vertexPage != nullptr)
+	// The page is full, a full remesh gives the direction a larger one
+	if (page == nullptr || (slot + 1) * VERTICES_PER_FACE > page->capacity)
 	{
-		m_vertexBuffer->GetDeviceMemory()->Unmap();
+		m_dirty = true;
+		return false;
 	}
 
-	m_world->ProcessVertexPages(m_vertexPage, m_matrix);
+	FaceSlot(direction, blockIndex) = static_cast<std::uint16_t>(slot);
+	m_slotBlock[direction].push_back(blockIndex);
+
+	WriteFaceToSlot(direction, slot, blockIndex, touchedPages);
+
+	return true;
 }
 
+void phx::Chunk::RemoveFace(int direction, std::uint16_t blockIndex, std::uint8_t& touchedPages)
+{
+	const std::uint32_t slot     = FaceSlot(direction, blockIndex);
+	const std::uint32_t lastSlot = static_cast<std::uint32_t>(m_slotBlock[direction].size()) - 1;
+
+	// Keep the faces packed by moving the last one into the hole
+	if (slot != lastSlot)
+	{
+		const std::uint16_t movedBlock = m_slotBlock[direction][lastSlot];
+
+		m_slotBlock[direction][slot]    = movedBlock;
+		FaceSlot(direction, movedBlock) = static_cast<std::uint16_t>(slot);
+
+		WriteFaceToSlot(direction, slot, movedBlock, touchedPages);
+	}
+
+	m_slotBlock[direction].pop_back();
+	FaceSlot(direction, blockIndex) = NO_FACE_SLOT;
+
+	// The page now draws one face less
+	touchedPages |= 1 << direction;
+}
+
+void phx::Chunk::WriteFaceToSlot(int direction, std::uint32_t slot, std::uint16_t blockIndex, std::uint8_t& touchedPages)
+{
+	VertexPage* page = m_directionPages[direction];
+
+	const int x = blockIndex >> (CHUNK_BLOCK_BIT_SIZE * 2);
+	const int y = (blockIndex >> CHUNK_BLOCK_BIT_SIZE) & CHUNK_BLOCK_BIT_SIZE_MASK;
+	const int z = blockIndex & CHUNK_BLOCK_BIT_SIZE_MASK;
+
+	VertexData face[VERTICES_PER_FACE];
+	WriteFace(face, glm::ivec3(x, y, z), 1, direction, BlockAt(x, y, z));
+
+	// Bounds only ever grow until the next full remesh, faces moved or removed by a patch leave them conservative
+	GrowPageBounds(page, face, VERTICES_PER_FACE);
+
+	void* memoryPtr = nullptr;
+	m_vertexBuffer->GetDeviceMemory()->Map(VERTICES_PER_FACE * sizeof(VertexData),
+	                                       m_vertexBuffer->GetMemoryOffset() +
+	                                           (page->offset + slot * VERTICES_PER_FACE) * sizeof(VertexData),
+	                                       memoryPtr);
+
+	StreamVertices(memoryPtr, face, VERTICES_PER_FACE);
+
+	m_vertexBuffer->GetDeviceMemory()->Unmap();
+
+	touchedPages |= 1 << direction;
+}
+
+void phx::Chunk::UploadVertices(void* mappedVertexBuffer, VertexPage* page, const VertexData* vertices)
+{
+	GrowPageBounds(page, vertices, page->vertexCount);
+
+	StreamVertices(static_cast<VertexData*>(mappedVertexBuffer) + page->offset, vertices, page->vertexCount);
+}
+
+void phx::Chunk::WriteFace(VertexData* vertexStream, glm::ivec3 position, int size, int direction, BlockStateID state)
+{
+	const std::uint32_t faceTextureID = m_blockStates->GetFaceTexture(state, direction);
+	// Loop through for the face vertices
+	for (int k = 0; k < VERTICES_PER_FACE; k++)
+	{
+		unsigned int lookupIndex = k + (direction * VERTICES_PER_FACE);
+
+		(*vertexStream).position = BLOCK_VERTICES[lookupIndex] * static_cast<float>(size) + glm::vec3(position);
+
+		(*vertexStream).normal = BLOCK_NORMALS[lookupIndex];
+
+		// The sampler repeats, so larger faces tile the texture at the same density as single blocks
+		(*vertexStream).uv = BLOCK_UVS[lookupIndex] * static_cast<float>(size);
+
+		(*vertexStream).textureID = faceTextureID;
+
+		vertexStream++;
+	}
+}
+
+phx::VertexPage* phx::Chunk::AllocateDirectionPage(int direction, std::uint32_t vertexCount)
+{
+	VertexPage* page = m_world->AllocateVertexPage(vertexCount, this);
+
+	if (page == nullptr)
+		return nullptr;
+
+	page->direction = static_cast<std::uint32_t>(direction);
+	page->next      = m_vertexPage;
+	m_vertexPage    = page;
+
+	m_directionPages[direction] = page;
+
+	return page;
+}
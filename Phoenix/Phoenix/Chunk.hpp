@@ -32,9 +32,12 @@
 
 #include <Globals/Globals.hpp>
 
+#include <Phoenix/BlockStates.hpp>
 #include <Phoenix/Blocks.hpp>
+#include <Phoenix/ChunkLayout.hpp>
 
 #include <memory>
+#include <vector>
 
 class Buffer;
 
@@ -50,7 +53,7 @@ namespace phx
 		uint32_t textureID;
 	};
 
-	class ModHandler;
+	class WorldGenerator;
 	class Chunk;
 
 	struct ChunkNeighbours
@@ -76,17 +79,16 @@ namespace phx
 		Chunk();
 		~Chunk() = default;
 
-		void Initialize(World* world, Buffer* vertexBuffer, ModHandler* modHandler);
+		void Initialize(World* world, Buffer* vertexBuffer, BlockStateRegistry* blockStates);
 
 		void SetPosition(glm::ivec3 position);
 
-		void SetRenderPosition(glm::vec3 position);
-
 		void Reset();
 
-		void GenerateWorld();
+		void GenerateWorld(WorldGenerator* generator);
 
-		void Update();
+		// Returns true when the mesh was rebuilt from scratch rather than patched or left alone
+		bool Update();
 
 		unsigned int GetTotalVertexCount();
 
@@ -95,8 +97,54 @@ namespace phx
 		ChunkBlock GetBlock(int x, int y, int z);
 		void     SetBlock(int x, int y, int z, ChunkBlock block);
 
+		// Same as GetBlock and SetBlock without going through the registry, for callers that resolved the state already
+		BlockStateID GetBlockState(int x, int y, int z) const { return BlockAt(x, y, z); }
+		void         SetBlockState(int x, int y, int z, BlockStateID state);
+
+		// Copies all MAX_BLOCKS_PER_CHUNK blocks out or in, in LinearChunkLayout order whatever the chunk stores them in.
+		// That is the order region files and world generators use.
+		void ReadBlocks(ChunkBlock* blocks) const;
+		void WriteBlocks(const ChunkBlock* blocks);
+
+		// Calls function(x, y, z, state) for every block in storage order, the fastest way to visit the whole chunk
+		template <typename Function>
+		void ForEachBlock(Function function) const
+		{
+			for (std::uint32_t i = 0; i < MAX_BLOCKS_PER_CHUNK; i++)
+			{
+				const glm::ivec3 position = ChunkLayout::Position(i);
+				function(position.x, position.y, position.z, m_blocks[i]);
+			}
+		}
+
+		// Set by SetBlock, the blocks differ from what was last generated, loaded or saved
+		bool IsModified();
+		void ClearModified();
+
+		// True when every block on the side of the chunk that face points out of is solid
+		bool IsBorderOpaque(Face face);
+
+		// Remeshes the whole chunk on the next Update
 		void MarkDirty();
 
+		// Frees the mesh's vertex memory straight away and remeshes on the next Update
+		void ReleaseMesh();
+
+		// Frees the mesh's vertex memory and leaves the chunk without one until the world has room for it again, the
+		// blocks are kept
+		void EvictMesh();
+
+		bool IsEvicted() const;
+
+		bool HasMesh() const;
+
+		// Patches only the faces of this block on the next Update, for when a block next to it has changed
+		void MarkBlockDirty(int x, int y, int z);
+
+		// Level of detail the chunk is meshed at, blocks are merged into cells 1 << lod blocks wide
+		void          SetLOD(std::uint32_t lod);
+		std::uint32_t GetLOD();
+
 		glm::ivec3 GetPosition();
 
 		ChunkNeighbours* GetNabours();
@@ -105,12 +153,68 @@ namespace phx
 	private:
 		void GenerateMesh();
 
+		void FreeMesh();
+
+		// Drops whatever part of the mesh was built and waits for room for all vertexCount vertices
+		void OnOutOfVertexMemory(std::uint32_t vertexCount);
+
+		// Solid all the way through with every neighbour solid on the shared side, so no face can ever be seen
+		bool IsEnclosed();
+
+		// Recounts the summary from scratch, after the blocks were replaced wholesale
+		void RebuildSummary();
+
+		void UpdateSummary(int x, int y, int z, bool wasSolid, bool isSolid);
+
+		BlockStateID&       BlockAt(int x, int y, int z) { return m_blocks[ChunkLayout::Index(x, y, z)]; }
+		const BlockStateID& BlockAt(int x, int y, int z) const { return m_blocks[ChunkLayout::Index(x, y, z)]; }
+
+		bool IsOpaqueAt(int x, int y, int z) const { return m_blockStates->IsOpaque(BlockAt(x, y, z)); }
+
+		// Meshes the chunk downsampled to the current level of detail
+		void GenerateLODMesh();
+
+		BlockStateID DownsampleCell(int originX, int originY, int originZ, int cellSize);
+
+		// Rewrites the faces of the queued blocks in place instead of rebuilding every page
+		void PatchMesh();
+
+		// Bit j is set when face j of the block is exposed
+		std::uint8_t ComputeFaceMask(int x, int y, int z);
+
+		void PatchBlockFaces(int x, int y, int z, std::uint8_t& touchedPages);
+
+		// Fills m_faceSlot from m_slotBlock
+		void BuildFaceSlots();
+
+		std::uint16_t& FaceSlot(int direction, std::uint16_t blockIndex)
+		{
+			return m_faceSlot[direction * MAX_BLOCKS_PER_CHUNK + blockIndex];
+		}
+
+		// Drops the slot maps and the memory behind them, for chunks left without a mesh for a while
+		void ReleaseSlotMemory();
+
+		bool AddFace(int direction, std::uint16_t blockIndex, std::uint8_t& touchedPages);
+
+		void RemoveFace(int direction, std::uint16_t blockIndex, std::uint8_t& touchedPages);
+
+		void WriteFaceToSlot(int direction, std::uint32_t slot, std::uint16_t blockIndex, std::uint8_t& touchedPages);
+
+		// Writes one face of a cube size blocks wide with its minimum corner at the chunk local position
+		void WriteFace(VertexData* vertexStream, glm::ivec3 position, int size, int direction, BlockStateID state);
+
+		// Copies page->vertexCount vertices from CPU memory into the page through the mapped vertex buffer
+		void UploadVertices(void* mappedVertexBuffer, VertexPage* page, const VertexData* vertices);
+
+		VertexPage* AllocateDirectionPage(int direction, std::uint32_t vertexCount);
+
 	private:
 		World*       m_world;
 		unsigned int m_totalVertexCount = 0;
 		Buffer*      m_vertexBuffer       = nullptr;
 
-		ModHandler* m_modHandler;
+		BlockStateRegistry* m_blockStates;
 
 		ChunkNeighbours* m_neighbouringChunk;
 
@@ -118,10 +222,40 @@ namespace phx
 
 		bool m_dirty = true;
 
+		bool m_modified = false;
+
+		std::uint32_t m_lod = 0;
+
+		// Kept up to date by SetBlock, so whether a chunk needs meshing at all is known without walking its blocks
+		std::uint32_t m_solidCount = 0;
+		std::uint32_t m_borderSolidCount[6];
+
+		// The last remesh was skipped, so there are no slot maps to patch
+		bool m_meshSkipped = false;
+
+		// No mesh for lack of vertex memory, m_evictedVertexCount is how much it needs to come back
+		bool          m_evicted            = false;
+		std::uint32_t m_evictedVertexCount = 0;
+
+		// Each direction keeps its faces packed in slot order in its own page. m_slotBlock holds the block of every
+		// slot, so a removed face can be filled by moving the last face into its slot. m_faceSlot maps blocks back to
+		// their slots, 6 * MAX_BLOCKS_PER_CHUNK entries built on the first patch after a remesh, most chunks are never
+		// edited and never need it.
+		std::vector<std::uint16_t>       m_slotBlock[6];
+		std::unique_ptr<std::uint16_t[]> m_faceSlot;
+
+		VertexPage* m_directionPages[6];
+
+		// Blocks waiting to be patched, once full the chunk falls back to a full remesh
+		static const unsigned int MAX_PENDING_BLOCKS = 128;
+
+		std::uint16_t m_pendingBlocks[MAX_PENDING_BLOCKS];
+		std::uint32_t m_pendingBlockCount = 0;
+
 		glm::ivec3 m_position;
-		glm::mat4 m_matrix;
 
-		ChunkBlock m_blocks[CHUNK_BLOCK_SIZE][CHUNK_BLOCK_SIZE][CHUNK_BLOCK_SIZE];
+		// In ChunkLayout order, only ever indexed through BlockAt or walked by ForEachBlock
+		BlockStateID m_blocks[MAX_BLOCKS_PER_CHUNK];
 	};
 } // namespace phx
 
@@ -0,0 +1,116 @@
+// BSD 3-Clause License
+// 
+// Copyright (c) 2022, Genten Studios
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <Globals/Globals.hpp>
+
+#include <cstdint>
+
+namespace phx
+{
+	// Compile time sizes of a chunk 1 << Log2Size blocks wide
+	template <unsigned int Log2Size>
+	struct ChunkDimensions
+	{
+		static constexpr unsigned int BIT_SIZE    = Log2Size;
+		static constexpr unsigned int SIZE        = 1u << Log2Size;
+		static constexpr unsigned int MASK        = SIZE - 1;
+		static constexpr unsigned int BLOCK_COUNT = SIZE * SIZE * SIZE;
+
+		// Step to the neighbouring block across each Chunk::Face, Top is towards -y
+		static constexpr int FACE_OFFSETS[6][3] = {{1, 0, 0}, {-1, 0, 0}, {0, -1, 0}, {0, 1, 0}, {0, 0, -1}, {0, 0, 1}};
+
+		// The same step as a distance in LinearChunkLayout order
+		static constexpr int LINEAR_FACE_STRIDES[6] = {
+		    static_cast<int>(SIZE * SIZE), -static_cast<int>(SIZE * SIZE), -static_cast<int>(SIZE), static_cast<int>(SIZE), -1, 1};
+	};
+
+	// Where a block lives in a chunk's storage. Both layouts keep x as the most significant coordinate.
+
+	// x major, the same as a [x][y][z] array. Neighbours along x are SIZE squared blocks apart.
+	template <unsigned int Log2Size>
+	struct BasicLinearChunkLayout
+	{
+		static std::uint32_t Index(int x, int y, int z) { return (x << (Log2Size * 2)) | (y << Log2Size) | z; }
+
+		static glm::ivec3 Position(std::uint32_t index)
+		{
+			return {static_cast<int>(index >> (Log2Size * 2)), static_cast<int>((index >> Log2Size) & ChunkDimensions<Log2Size>::MASK),
+			        static_cast<int>(index & ChunkDimensions<Log2Size>::MASK)};
+		}
+	};
+
+	// Z-order, the bits of the three coordinates are interleaved so every 2x2x2, 4x4x4 and 8x8x8 block of the chunk is
+	// contiguous. Neighbours along any axis are usually within the same few cache lines.
+	template <unsigned int Log2Size>
+	struct BasicMortonChunkLayout
+	{
+		static_assert(Log2Size <= 10, "Interleaved indices must fit in 32 bits");
+
+		// Moves bit n of a coordinate to bit 3n
+		static constexpr std::uint32_t Spread(std::uint32_t value)
+		{
+			std::uint32_t spread = 0;
+			for (unsigned int bit = 0; bit < Log2Size; bit++)
+				spread |= ((value >> bit) & 1u) << (bit * 3);
+			return spread;
+		}
+
+		static constexpr std::uint32_t Compact(std::uint32_t value)
+		{
+			std::uint32_t compact = 0;
+			for (unsigned int bit = 0; bit < Log2Size; bit++)
+				compact |= ((value >> (bit * 3)) & 1u) << bit;
+			return compact;
+		}
+
+		static std::uint32_t Index(int x, int y, int z) { return (Spread(x) << 2) | (Spread(y) << 1) | Spread(z); }
+
+		static glm::ivec3 Position(std::uint32_t index)
+		{
+			return {static_cast<int>(Compact(index >> 2)), static_cast<int>(Compact(index >> 1)), static_cast<int>(Compact(index))};
+		}
+	};
+
+	// Sized for the chunks of this build, see CHUNK_BLOCK_BIT_SIZE
+	using ChunkSize          = ChunkDimensions<CHUNK_BLOCK_BIT_SIZE>;
+	using LinearChunkLayout  = BasicLinearChunkLayout<CHUNK_BLOCK_BIT_SIZE>;
+	using MortonChunkLayout  = BasicMortonChunkLayout<CHUNK_BLOCK_BIT_SIZE>;
+
+	static_assert(ChunkSize::BLOCK_COUNT == MAX_BLOCKS_PER_CHUNK, "Chunk dimensions must match Globals.hpp");
+
+	// Layout chunks store their blocks in, define PHX_LINEAR_CHUNK_LAYOUT to go back to x major storage
+#ifdef PHX_LINEAR_CHUNK_LAYOUT
+	using ChunkLayout = LinearChunkLayout;
+#else
+	using ChunkLayout = MortonChunkLayout;
+#endif
+} // namespace phx
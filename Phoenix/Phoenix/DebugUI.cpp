@@ -30,6 +30,8 @@
 
 #include <Phoenix/DebugUI.hpp>
 
+#include <cassert>
+#include <cstring>
 #include <functional>
 
 #include <Windowing/Window.hpp>
@@ -38,6 +40,7 @@
 #include <Renderer/ResourceTable.hpp>
 #include <Renderer/ResourceTableLayout.hpp>
 #include <Renderer/Buffer.hpp>
+#include <Renderer/DeviceMemory.hpp>
 #include <Renderer/MemoryHeap.hpp>
 #include <Renderer/RenderTarget.hpp>
 #include <Renderer/Pipeline.hpp>
@@ -52,6 +55,21 @@ const char* FONT_NAME = "Font";
 const uint32_t MAX_VERTICIES = 100000;
 const uint32_t MAX_INDEXES = 100000;
 const uint32_t MAX_DRAW_CALLS = 1000;
+
+// Per draw data read through the instance rate vertex binding, the draw's firstInstance selects it
+struct DrawRecord
+{
+	ImVec4 clipRect;
+	int32_t textureID;
+};
+
+// Layout of one frame slice of the UI ring buffer
+const VkDeviceSize RING_VERTEX_OFFSET = 0;
+const VkDeviceSize RING_INDEX_OFFSET = RING_VERTEX_OFFSET + sizeof(ImDrawVert) * MAX_VERTICIES;
+const VkDeviceSize RING_DRAW_RECORD_OFFSET = RING_INDEX_OFFSET + sizeof(ImDrawIdx) * MAX_INDEXES;
+const VkDeviceSize RING_INDIRECT_OFFSET = RING_DRAW_RECORD_OFFSET + sizeof(DrawRecord) * MAX_DRAW_CALLS;
+const VkDeviceSize RING_DRAW_COUNT_OFFSET = RING_INDIRECT_OFFSET + sizeof(VkDrawIndexedIndirectCommand) * MAX_DRAW_CALLS;
+const VkDeviceSize RING_FRAME_SIZE = (RING_DRAW_COUNT_OFFSET + sizeof(uint32_t) + 255) & ~VkDeviceSize(255);
 const float FONT_SIZE = 20.0f;
 
 
@@ -64,8 +82,6 @@ DebugUI::DebugUI(RenderDevice* device, ResourceManager* resourecManager, Window*
 	ViewportResize();
 	InitRenderPassResources();
 	CreatePipelines();
-
-	mOutOfDateDateCMD = true;
 }
 
 DebugUI::~DebugUI()
@@ -78,10 +94,9 @@ DebugUI::~DebugUI()
 	delete mImGuiPipeline;
 
 	delete mImGuiConfigurationBuffer;
-	delete mImGuiVetexBuffer;
-	delete mImGuiTextureVetexBuffer;
-	delete mImGuiIndexBuffer;
-	delete mImGuiIndirectDrawBuffer;
+
+	mImGuiRingBuffer->GetDeviceMemory()->Unmap();
+	delete mImGuiRingBuffer;
 
 	delete mRenderTarget;
 
@@ -132,53 +147,62 @@ void DebugUI::Use(VkCommandBuffer* commandBuffers, uint32_t index, bool useParen
 		&scissor
 	);
 
+	assert(index < mImGuiRingFrameCount && "UI ring has no slice for the swapchain image");
+	const VkDeviceSize frameOffset = index * RING_FRAME_SIZE;
+
 	mImGuiPipeline->Use(commandBuffers, index);
 	mImGuiSamplersTable->Use(commandBuffers, index, 0, mImGuiPipelineLayout->GetPipelineLayout());
 	mImGuiConfigurationTable->Use(commandBuffers, index, 1, mImGuiPipelineLayout->GetPipelineLayout());
 
 	{
-		VkDeviceSize offsets[] = { 0 };
+		VkDeviceSize offsets[] = { frameOffset + RING_VERTEX_OFFSET };
 		vkCmdBindVertexBuffers(
 			commandBuffers[index],
 			0,
 			1,
-			&mImGuiVetexBuffer->GetBuffer(),
+			&mImGuiRingBuffer->GetBuffer(),
 			offsets
 		);
 	}
 	{
 		vkCmdBindIndexBuffer(
 			commandBuffers[index],
-			mImGuiIndexBuffer->GetBuffer(),
-			0,
-			VK_INDEX_TYPE_UINT32
+			mImGuiRingBuffer->GetBuffer(),
+			frameOffset + RING_INDEX_OFFSET,
+			sizeof(ImDrawIdx) == sizeof(uint16_t) ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32
 		);
 	}
 
-	for (uint32_t i = 0; i < MAX_DRAW_CALLS; i++)
 	{
-
-		vkCmdSetScissor(
-			commandBuffers[index],
-			0,
-			1,
-			&mScissors.get()[i]
-		);
-
-		VkDeviceSize offsets[] = { i * sizeof(int32_t) };
+		VkDeviceSize offsets[] = { frameOffset + RING_DRAW_RECORD_OFFSET };
 		vkCmdBindVertexBuffers(
 			commandBuffers[index],
 			1,
 			1,
-			&mImGuiTextureVetexBuffer->GetBuffer(),
+			&mImGuiRingBuffer->GetBuffer(),
 			offsets
 		);
+	}
 
+	// Clipping happens in the fragment shader from the draw records, so nothing recorded here depends on the UI content
+	if (mDevice->SupportsDrawIndirectCount())
+	{
+		vkCmdDrawIndexedIndirectCountKHR(
+			commandBuffers[index],
+			mImGuiRingBuffer->GetBuffer(),
+			frameOffset + RING_INDIRECT_OFFSET,
+			mImGuiRingBuffer->GetBuffer(),
+			frameOffset + RING_DRAW_COUNT_OFFSET,
+			MAX_DRAW_CALLS,
+			sizeof(VkDrawIndexedIndirectCommand));
+	}
+	else
+	{
 		vkCmdDrawIndexedIndirect(
 			commandBuffers[index],
-			mImGuiIndirectDrawBuffer->GetBuffer(),
-			i * sizeof(VkDrawIndexedIndirectCommand),
-			1,
+			mImGuiRingBuffer->GetBuffer(),
+			frameOffset + RING_INDIRECT_OFFSET,
+			MAX_DRAW_CALLS,
 			sizeof(VkDrawIndexedIndirectCommand));
 	}
 
@@ -223,40 +247,33 @@ void DebugUI::Update(float delta)
 	int fb_width = (int)(imDrawData->DisplaySize.x * imDrawData->FramebufferScale.x);
 	int fb_height = (int)(imDrawData->DisplaySize.y * imDrawData->FramebufferScale.y);
 
-	ImDrawVert* temp_vertex_data = mImGuiVetexBufferCPU.get();
-	uint32_t* temp_index_data = mImGuiIndexBufferCPU.get();
-	int32_t* temp_texture_data = mImGuiTextureVetexBufferCPU.get();
-	VkDrawIndexedIndirectCommand* temp_indirect_draw = mImGuiIndirectDrawBufferCPU.get();
+	// Written straight into the slice of the image this frame is presented to, the acquire made sure the GPU is done with it
+	const uint32_t frame = mDevice->GetSwapchainImageIndex();
+	char* frameData = mImGuiRingBufferPtr + frame * RING_FRAME_SIZE;
+
+	ImDrawVert* temp_vertex_data = reinterpret_cast<ImDrawVert*>(frameData + RING_VERTEX_OFFSET);
+	ImDrawIdx* temp_index_data = reinterpret_cast<ImDrawIdx*>(frameData + RING_INDEX_OFFSET);
+	DrawRecord* temp_draw_records = reinterpret_cast<DrawRecord*>(frameData + RING_DRAW_RECORD_OFFSET);
+	VkDrawIndexedIndirectCommand* temp_indirect_draw = reinterpret_cast<VkDrawIndexedIndirectCommand*>(frameData + RING_INDIRECT_OFFSET);
 
 	unsigned int index_count = 0;
 	unsigned int vertex_count = 0;
-	int drawGroup = 0;
-
-	for (uint32_t i = 0; i < MAX_DRAW_CALLS; i++)
-	{
-		temp_indirect_draw[i].instanceCount = 0;
-	}
-
-	mOutOfDateDateCMD = false;
+	uint32_t drawGroup = 0;
 
 	for (int n = 0; n < imDrawData->CmdListsCount; n++)
 	{
 
 		const ImDrawList* cmd_list = imDrawData->CmdLists[n];
 
-		memcpy(temp_vertex_data, cmd_list->VtxBuffer.Data, cmd_list->VtxBuffer.Size * sizeof(ImDrawVert));
+		// Lists that would overflow the slice are dropped for this frame
+		if (vertex_count + cmd_list->VtxBuffer.Size > MAX_VERTICIES || index_count + cmd_list->IdxBuffer.Size > MAX_INDEXES)
+			break;
 
-		// Loop through and manually add a offset to the index's so they can all be rendered in one render pass
-		for (int i = 0; i < cmd_list->VtxBuffer.Size; i++)
-		{
-			temp_vertex_data[i] = cmd_list->VtxBuffer.Data[i];
-		}
-		for (int i = 0; i < cmd_list->IdxBuffer.Size; i++)
-		{
-			temp_index_data[i] = cmd_list->IdxBuffer.Data[i];
-		}
+		// Indices stay relative to their own list, the draw's vertexOffset rebases them so they can all be rendered in one render pass
+		memcpy(temp_vertex_data, cmd_list->VtxBuffer.Data, cmd_list->VtxBuffer.Size * sizeof(ImDrawVert));
+		memcpy(temp_index_data, cmd_list->IdxBuffer.Data, cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx));
 
-		for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
+		for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size && drawGroup < MAX_DRAW_CALLS; cmd_i++)
 		{
 			const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
 
@@ -272,36 +289,17 @@ void DebugUI::Update(float delta)
 			// If the object is out of the scissor, ignore it
 			if (clip_rect.x < fb_width && clip_rect.y < fb_height && clip_rect.z >= 0.0f && clip_rect.w >= 0.0f)
 			{
-				// Negative offsets are illegal for vkCmdSetScissor
-				if (clip_rect.x < 0.0f)
-					clip_rect.x = 0.0f;
-				if (clip_rect.y < 0.0f)
-					clip_rect.y = 0.0f;
-
-				// Generate a vulkan friendly scissor area
-				VkRect2D scissor;
-				scissor.offset.x = (int32_t)(clip_rect.x);
-				scissor.offset.y = (int32_t)(clip_rect.y);
-				scissor.extent.width = (uint32_t)(clip_rect.z - clip_rect.x);
-				scissor.extent.height = (uint32_t)(clip_rect.w - clip_rect.y);
-
-
-				if (scissor.offset.x != mScissors.get()[drawGroup].offset.x || scissor.offset.y != mScissors.get()[drawGroup].offset.y ||
-					scissor.extent.width != mScissors.get()[drawGroup].extent.width || scissor.extent.height != mScissors.get()[drawGroup].extent.height)
-				{
-					mOutOfDateDateCMD = true;
-					mScissors.get()[drawGroup] = scissor;
-				}
-
+				// The fragment shader discards everything outside the clip area, that stands in for a per draw scissor
+				DrawRecord& draw_record = temp_draw_records[drawGroup];
+				draw_record.clipRect = clip_rect;
+				draw_record.textureID = (int32_t)(intptr_t)pcmd->TextureId;
 
 				VkDrawIndexedIndirectCommand& indirect_command = temp_indirect_draw[drawGroup];
 				indirect_command.indexCount = pcmd->ElemCount;
 				indirect_command.instanceCount = 1;
 				indirect_command.firstIndex = pcmd->IdxOffset + index_count;
 				indirect_command.vertexOffset = pcmd->VtxOffset + vertex_count;
-				indirect_command.firstInstance = 0;
-
-				temp_texture_data[drawGroup] = (intptr_t)pcmd->TextureId;
+				indirect_command.firstInstance = drawGroup;
 
 				drawGroup++;
 			}
@@ -314,10 +312,15 @@ void DebugUI::Update(float delta)
 		index_count += cmd_list->IdxBuffer.Size;
 	}
 
-	mImGuiVetexBuffer->TransferInstantly(mImGuiVetexBufferCPU.get(), mImGuiVetexBuffer->GetBufferSize());
-	mImGuiTextureVetexBuffer->TransferInstantly(mImGuiTextureVetexBufferCPU.get(), mImGuiTextureVetexBuffer->GetBufferSize());
-	mImGuiIndexBuffer->TransferInstantly(mImGuiIndexBufferCPU.get(), mImGuiIndexBuffer->GetBufferSize());
-	mImGuiIndirectDrawBuffer->TransferInstantly(mImGuiIndirectDrawBufferCPU.get(), mImGuiIndirectDrawBuffer->GetBufferSize());
+	// Only the draws this slice used last time need disabling, the rest were never written
+	uint32_t& previousDrawGroup = mImGuiRingDrawCount[frame];
+	for (uint32_t i = drawGroup; i < previousDrawGroup; i++)
+	{
+		temp_indirect_draw[i].instanceCount = 0;
+	}
+	previousDrawGroup = drawGroup;
+
+	*reinterpret_cast<uint32_t*>(frameData + RING_DRAW_COUNT_OFFSET) = drawGroup;
 }
 
 void DebugUI::ViewportResize()
@@ -453,20 +456,6 @@ void DebugUI::CreateResourceTableLayouts()
 void DebugUI::CreateBuffers()
 {
 
-	mImGuiVetexBufferCPU = std::unique_ptr<ImDrawVert>(new ImDrawVert[MAX_VERTICIES]);
-	mImGuiIndexBufferCPU = std::unique_ptr<uint32_t>(new uint32_t[MAX_INDEXES]);
-	mImGuiTextureVetexBufferCPU = std::unique_ptr<int32_t>(new int32_t[MAX_DRAW_CALLS]);
-	mImGuiIndirectDrawBufferCPU = std::unique_ptr<VkDrawIndexedIndirectCommand>(new VkDrawIndexedIndirectCommand[MAX_DRAW_CALLS]);
-
-
-	{
-		mScissors = std::unique_ptr<VkRect2D>(new VkRect2D[MAX_DRAW_CALLS]);
-		for (uint32_t i = 0; i < MAX_DRAW_CALLS; i++)
-		{
-			mScissors.get()[i] = {};
-		}
-	}
-
 	MemoryHeap* GPUMappableMemoryHeap = mResourceManager->GetResource<MemoryHeap>("GPUMappableMemoryHeap");
 	MemoryHeap* deviceLocalMemoryHeap = mResourceManager->GetResource<MemoryHeap>("DeviceLocalMemoryHeap");
 
@@ -508,31 +497,26 @@ void DebugUI::CreateBuffers()
 		mImGuiConfigurationTable->Bind(0, mImGuiConfigurationBuffer);
 	}
 	{
+		// Owns its memory so it can stay mapped, the shared mappable heap is mapped and unmapped by everyone else
+		mImGuiRingFrameCount = mDevice->GetSwapchainImageCount();
 
-		mImGuiVetexBuffer = new Buffer(
-			mDevice, GPUMappableMemoryHeap, sizeof(ImDrawVert) * MAX_VERTICIES,
-			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE
+		mImGuiRingBuffer = new Buffer(
+			mDevice, RING_FRAME_SIZE * mImGuiRingFrameCount,
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE
 		);
-	}
-	{
 
-		mImGuiTextureVetexBuffer = new Buffer(
-			mDevice, GPUMappableMemoryHeap, sizeof(int32_t) * MAX_DRAW_CALLS,
-			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE
-		);
-	}
-	{
+		void* memoryPtr = nullptr;
+		mImGuiRingBuffer->GetDeviceMemory()->Map(mImGuiRingBuffer->GetBufferSize(), mImGuiRingBuffer->GetMemoryOffset(), memoryPtr);
+		mImGuiRingBufferPtr = reinterpret_cast<char*>(memoryPtr);
 
-		mImGuiIndexBuffer = new Buffer(
-			mDevice, GPUMappableMemoryHeap, sizeof(uint32_t) * MAX_INDEXES,
-			VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE
-		);
-	}
-	{
-		mImGuiIndirectDrawBuffer = new Buffer(
-			mDevice, GPUMappableMemoryHeap, sizeof(VkDrawIndexedIndirectCommand) * MAX_DRAW_CALLS,
-			VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT, VK_SHARING_MODE_EXCLUSIVE
-		);
+		// Every draw starts disabled
+		memset(mImGuiRingBufferPtr, 0, mImGuiRingBuffer->GetBufferSize());
+
+		mImGuiRingDrawCount = std::unique_ptr<uint32_t[]>(new uint32_t[mImGuiRingFrameCount]);
+		for (uint32_t i = 0; i < mImGuiRingFrameCount; i++)
+		{
+			mImGuiRingDrawCount[i] = 0;
+		}
 	}
 }
 
@@ -577,13 +561,13 @@ void DebugUI::CreatePipelines()
 		vertexInputBindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
 		vertexInputBindingDescriptions[0].stride = sizeof(ImDrawVert);
 
-		// Texture ID
+		// Clip rect, Texture ID
 		vertexInputBindingDescriptions[1].binding = 1;
 		vertexInputBindingDescriptions[1].inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
-		vertexInputBindingDescriptions[1].stride = sizeof(int);
+		vertexInputBindingDescriptions[1].stride = sizeof(DrawRecord);
 	}
 
-	VkVertexInputAttributeDescription vertexInputAttributeDescriptions[4];
+	VkVertexInputAttributeDescription vertexInputAttributeDescriptions[5];
 	{
 		// Position
 		vertexInputAttributeDescriptions[0].binding = 0;
@@ -607,7 +591,13 @@ void DebugUI::CreatePipelines()
 		vertexInputAttributeDescriptions[3].binding = 1;
 		vertexInputAttributeDescriptions[3].location = 3;
 		vertexInputAttributeDescriptions[3].format = VK_FORMAT_R32_SINT;
-		vertexInputAttributeDescriptions[3].offset = 0;
+		vertexInputAttributeDescriptions[3].offset = offsetof(DrawRecord, textureID);
+
+		// Clip rect
+		vertexInputAttributeDescriptions[4].binding = 1;
+		vertexInputAttributeDescriptions[4].location = 4;
+		vertexInputAttributeDescriptions[4].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+		vertexInputAttributeDescriptions[4].offset = offsetof(DrawRecord, clipRect);
 	}
 
 
@@ -639,7 +629,7 @@ void DebugUI::CreatePipelines()
 		mDevice, PipelineType::Graphics, mRenderTarget->GetRenderPass(), mImGuiPipelineLayout,
 		pipelineShaderStageCreateInfos, 2,
 		vertexInputBindingDescriptions, 2,
-		vertexInputAttributeDescriptions, 4,
+		vertexInputAttributeDescriptions, 5,
 		VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST
 	);
 }
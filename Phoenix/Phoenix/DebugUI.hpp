@@ -74,8 +74,6 @@ public:
 
 	void Update(float delta);
 
-	bool IsCMDOutdated() { return mOutOfDateDateCMD; }
-
 	void ViewportResize();
 
 	void AddRenderCallback(std::function<void(void*)> callback, void* ref);
@@ -100,8 +98,6 @@ private:
 	RenderTarget* mRenderTarget = nullptr;
 	ResourceManager* mResourceManager;
 
-	bool mOutOfDateDateCMD = false;
-
 	ResourceTableLayout* mImGuiConfigurationTableLayout = nullptr;
 	ResourceTableLayout* mImGuiSamplersTableLayout = nullptr;
 	ResourceTable* mImGuiConfigurationTable = nullptr;
@@ -111,22 +107,21 @@ private:
 
 	ImGuiConfiguration mImGuiConfiguration;
 	Buffer* mImGuiConfigurationBuffer = nullptr;
-	Buffer* mImGuiVetexBuffer = nullptr;
-	Buffer* mImGuiTextureVetexBuffer = nullptr;
-	Buffer* mImGuiIndexBuffer = nullptr;
-	Buffer* mImGuiIndirectDrawBuffer = nullptr;
 
-	std::unique_ptr<ImDrawVert> mImGuiVetexBufferCPU;
-	std::unique_ptr<uint32_t> mImGuiIndexBufferCPU;
-	std::unique_ptr<int32_t> mImGuiTextureVetexBufferCPU;
-	std::unique_ptr<VkDrawIndexedIndirectCommand> mImGuiIndirectDrawBufferCPU;
+	// Persistently mapped ring with one slice per swapchain image, each slice holds the vertices, indices,
+	// draw records, indirect draws and draw count of one frame
+	Buffer* mImGuiRingBuffer = nullptr;
+	char* mImGuiRingBufferPtr = nullptr;
+	uint32_t mImGuiRingFrameCount = 0;
+
+	// Draws written to each slice, so only those have to be cleared when the slice is reused without draw indirect count
+	std::unique_ptr<uint32_t[]> mImGuiRingDrawCount;
 
 	Texture* mFontTexture = nullptr;
 
 	std::vector<RenderCallback> mRenderCallbacks;
 	std::vector<RenderCallback> mMainMenuCallbacks;
 
-	std::unique_ptr<VkRect2D> mScissors;
 	std::map<std::string, VkShaderModule> mShaderModules;
 
 };
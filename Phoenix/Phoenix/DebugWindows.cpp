@@ -30,6 +30,10 @@
 
 #include <Phoenix/DebugWindows.hpp>
 #include <Phoenix/Phoenix.hpp>
+#include <Phoenix/BlockStates.hpp>
+#include <Phoenix/RegionStore.hpp>
+#include <Phoenix/VertexAllocator.hpp>
+#include <Phoenix/WorldGenerator.hpp>
 #include <Phoenix/DebugUI.hpp>
 #include <Phoenix/Chunk.hpp>
 #include <Phoenix/World.hpp>
@@ -53,6 +57,21 @@ void DebugUIMainMenuBar(void* ref)
 		ImGui::MenuItem("Show Render Statistics", NULL, &DisplayRenderStatistics, true);
 		ImGui::MenuItem("Show Memory Usage", NULL, &DisplayMemoryUsage, true);
 
+		if (ImGui::MenuItem("Benchmark Region Files"))
+		{
+			engine->GetResourceManager()->GetResource<phx::World>("World")->BenchmarkRegionStore();
+		}
+
+		if (ImGui::MenuItem("Benchmark Chunk Layouts"))
+		{
+			engine->GetResourceManager()->GetResource<phx::World>("World")->BenchmarkChunkLayouts();
+		}
+
+		if (ImGui::MenuItem("Defragment Vertex Memory"))
+		{
+			engine->GetResourceManager()->GetResource<phx::World>("World")->DefragmentVertexMemory();
+		}
+
 
 		ImGui::EndMenu();
 	}
@@ -87,6 +106,18 @@ void DebugUIRenderSystemStatistics(void* ref)
 
 	ImGui::Text("FPS: %i", (int)fps);
 
+	phx::World* world = engine->GetResourceManager()->GetResource<phx::World>("World");
+	ImGui::Text("Occluded Pages: %u", world->GetOccludedPageCount());
+	ImGui::Text("Chunk Saves: %.0f/s", world->GetRegionStore()->GetSaveChunksPerSecond());
+	ImGui::Text("Chunk Loads: %.0f/s", world->GetRegionStore()->GetLoadChunksPerSecond());
+	ImGui::Text("Chunk Size: %u^3 blocks", CHUNK_BLOCK_SIZE);
+	ImGui::Text("Block States: %u",
+	            engine->GetResourceManager()->GetResource<phx::BlockStateRegistry>("BlockStateRegistry")->GetStateCount());
+	ImGui::Text("Chunk Generation: %.3gms", world->GetGenerator()->GetAverageChunkMilliseconds());
+	ImGui::Text("Chunk Meshing: %.3gms", world->GetAverageMeshMilliseconds());
+	ImGui::Text("Chunk Layout Sweep: Linear %.3gms | Morton %.3gms", world->GetLinearLayoutMilliseconds(),
+	            world->GetMortonLayoutMilliseconds());
+
 	for (auto& it : engine->GetStatistics().GetRecordings())
 	{
 		ImGui::Text("%s: %.3gms", it.name.c_str(), it.time);
@@ -117,22 +148,28 @@ void DebugUIMemoryUsage(void* ref)
 		return;
 	}
 
-	unsigned int totalPools = TOTAL_VERTEX_PAGE_COUNT;
-	unsigned int freePools     = world->GetFreeMemoryPoolCount();
-	float        poolUsageFrac = 1.0f - ((float) freePools / (float) totalPools);
+	const phx::VertexAllocator::Statistics vertexStatistics = world->GetVertexAllocator()->GetStatistics();
 
-	const unsigned int  memoryPoolPageSize      = VERTEX_PAGE_SIZE * sizeof(phx::VertexData);
-	const unsigned int  totalMemoryPoolMemory   = memoryPoolPageSize * TOTAL_VERTEX_PAGE_COUNT;
-	unsigned int        memoryPoolmemoryUsage   = memoryPoolPageSize * (TOTAL_VERTEX_PAGE_COUNT - freePools);
-	const float         totalMemoryPoolMemoryMB = (float) (totalMemoryPoolMemory) / 1024.0f / 1024.0f;
-	float               memoryPoolmemoryUsageMB   = (float) (memoryPoolmemoryUsage) / 1024.0f / 1024.0f;
+	const float bytesToMB         = (float) sizeof(phx::VertexData) / 1024.0f / 1024.0f;
+	const float totalVertexMB     = (float) vertexStatistics.totalSize * bytesToMB;
+	const float usedVertexMB      = (float) vertexStatistics.usedSize * bytesToMB;
+	const float largestFreeMB     = (float) vertexStatistics.largestFreeRange * bytesToMB;
+	const float reclaimableMB     = (float) (vertexStatistics.totalSize - vertexStatistics.usedSize - vertexStatistics.largestFreeRange) * bytesToMB;
+	float       vertexUsageFrac   = (float) vertexStatistics.usedSize / (float) vertexStatistics.totalSize;
 
+	ImGui::Text("Vertex Pages: %i | Free Ranges: %i", vertexStatistics.allocationCount, vertexStatistics.freeRangeCount);
+	ImGui::Text("Total Vertex Memory: %.3gmb | Used Vertex Memory: %.3gmb", totalVertexMB, usedVertexMB);
+	ImGui::ProgressBar(vertexUsageFrac);
 
-	ImGui::Text("Total Pools: %i | Free Pools: %i", totalPools, freePools);
-	ImGui::Text("Total Pool Memory: %.3gmb | Used Pool Memory: %.3gmb", totalMemoryPoolMemoryMB, memoryPoolmemoryUsageMB);
-	ImGui::ProgressBar(poolUsageFrac);
+	// What a defragment would gain, the free space outside of the largest range only fits smaller pages
+	ImGui::Text("Fragmentation: %.1f%% | Largest Free Range: %.3gmb", world->GetVertexAllocator()->GetFragmentation() * 100.0f, largestFreeMB);
+	ImGui::Text("Reclaimed By Defragmenting: %.3gmb", reclaimableMB);
 
+	const float budgetMB = (float) world->GetVertexBudget() * bytesToMB;
 
+	ImGui::Text("Vertex Budget: %.3gmb", budgetMB);
+	ImGui::Text("Evicted Chunks: %u | Total Evictions: %llu", world->GetEvictedChunkCount(),
+	            (unsigned long long) world->GetEvictionCount());
 
 	ImGui::SetWindowSize(ImVec2(400, ImGui::GetCursorPosY()));
 
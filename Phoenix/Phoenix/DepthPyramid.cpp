@@ -0,0 +1,295 @@
+// BSD 3-Clause License
+// 
+// Copyright (c) 2022, Genten Studios
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <Phoenix/DepthPyramid.hpp>
+
+#include <Renderer/Device.hpp>
+#include <Renderer/DeviceMemory.hpp>
+#include <Renderer/MemoryHeap.hpp>
+#include <Renderer/Pipeline.hpp>
+#include <Renderer/PipelineLayout.hpp>
+#include <Renderer/ResourceTable.hpp>
+#include <Renderer/ResourceTableLayout.hpp>
+#include <Renderer/Texture.hpp>
+
+#include <ResourceManager/RenderTechnique.hpp>
+#include <ResourceManager/ResourceManager.hpp>
+
+#include <algorithm>
+
+phx::DepthPyramid::DepthPyramid(RenderDevice* device, ResourceManager* resourceManager, Texture* depthImage)
+    : mDevice(device), mResourceManager(resourceManager), mDepthImage(depthImage)
+{
+	ResourceTableLayout* reduceResourceTableLayout =
+	    mResourceManager->GetResource<ResourceTableLayout>("DepthPyramidReduceResourceTableLayout");
+
+	for (uint32_t i = 0; i < MAX_DEPTH_PYRAMID_LEVELS; ++i)
+	{
+		mReduceResourceTables[i] = std::unique_ptr<ResourceTable>(reduceResourceTableLayout->CreateTable());
+	}
+
+	mResourceTable =
+	    std::unique_ptr<ResourceTable>(mResourceManager->GetResource<ResourceTableLayout>("DepthPyramidResourceTableLayout")->CreateTable());
+
+	CreatePyramid();
+}
+
+phx::DepthPyramid::~DepthPyramid() { DestroyPyramid(); }
+
+void phx::DepthPyramid::ScreenResize(Texture* depthImage)
+{
+	mDepthImage = depthImage;
+
+	DestroyPyramid();
+	CreatePyramid();
+}
+
+void phx::DepthPyramid::Build(VkCommandBuffer* commandBuffer, uint32_t index)
+{
+	VkImageAspectFlags depthAspectMask = VK_IMAGE_ASPECT_DEPTH_BIT;
+	if (mDepthImage->GetFormat() == VK_FORMAT_D32_SFLOAT_S8_UINT || mDepthImage->GetFormat() == VK_FORMAT_D24_UNORM_S8_UINT)
+	{
+		depthAspectMask |= VK_IMAGE_ASPECT_STENCIL_BIT;
+	}
+
+	{
+		VkImageMemoryBarrier barriers[2] = {};
+
+		// Finish the early world pass before reading its depth
+		barriers[0].sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barriers[0].srcAccessMask       = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		barriers[0].dstAccessMask       = VK_ACCESS_SHADER_READ_BIT;
+		barriers[0].oldLayout           = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		barriers[0].newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barriers[0].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barriers[0].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barriers[0].image               = mDepthImage->GetImage();
+		barriers[0].subresourceRange    = {depthAspectMask, 0, 1, 0, 1};
+
+		// The previous frame's occlusion pass may still be sampling the pyramid
+		barriers[1].sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barriers[1].srcAccessMask       = VK_ACCESS_SHADER_READ_BIT;
+		barriers[1].dstAccessMask       = VK_ACCESS_SHADER_WRITE_BIT;
+		barriers[1].oldLayout           = VK_IMAGE_LAYOUT_GENERAL;
+		barriers[1].newLayout           = VK_IMAGE_LAYOUT_GENERAL;
+		barriers[1].srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barriers[1].dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barriers[1].image               = mImage;
+		barriers[1].subresourceRange    = {VK_IMAGE_ASPECT_COLOR_BIT, 0, mLevelCount, 0, 1};
+
+		vkCmdPipelineBarrier(commandBuffer[index], VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+		                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 2, barriers);
+	}
+
+	RenderTechnique* reducePipeline = mResourceManager->GetResource<RenderTechnique>("DepthPyramid");
+
+	reducePipeline->GetPipeline()->Use(commandBuffer, index);
+
+	uint32_t levelWidth  = mWidth;
+	uint32_t levelHeight = mHeight;
+
+	for (uint32_t i = 0; i < mLevelCount; ++i)
+	{
+		mReduceResourceTables[i]->Use(commandBuffer, index, 0, reducePipeline->GetPipelineLayout()->GetPipelineLayout(),
+		                              VK_PIPELINE_BIND_POINT_COMPUTE);
+
+		vkCmdDispatch(commandBuffer[index], (levelWidth + DEPTH_PYRAMID_WORKGROUP_SIZE - 1) / DEPTH_PYRAMID_WORKGROUP_SIZE,
+		              (levelHeight + DEPTH_PYRAMID_WORKGROUP_SIZE - 1) / DEPTH_PYRAMID_WORKGROUP_SIZE, 1);
+
+		// The next level reads this one, the last level is read by the occlusion culling pass
+		VkImageMemoryBarrier levelBarrier = {};
+		levelBarrier.sType                = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		levelBarrier.srcAccessMask        = VK_ACCESS_SHADER_WRITE_BIT;
+		levelBarrier.dstAccessMask        = VK_ACCESS_SHADER_READ_BIT;
+		levelBarrier.oldLayout            = VK_IMAGE_LAYOUT_GENERAL;
+		levelBarrier.newLayout            = VK_IMAGE_LAYOUT_GENERAL;
+		levelBarrier.srcQueueFamilyIndex  = VK_QUEUE_FAMILY_IGNORED;
+		levelBarrier.dstQueueFamilyIndex  = VK_QUEUE_FAMILY_IGNORED;
+		levelBarrier.image                = mImage;
+		levelBarrier.subresourceRange     = {VK_IMAGE_ASPECT_COLOR_BIT, i, 1, 0, 1};
+
+		vkCmdPipelineBarrier(commandBuffer[index], VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0,
+		                     nullptr, 0, nullptr, 1, &levelBarrier);
+
+		levelWidth  = std::max(levelWidth / 2, 1u);
+		levelHeight = std::max(levelHeight / 2, 1u);
+	}
+
+	// Hand the depth back to the late world pass, which continues on top of it
+	VkImageMemoryBarrier depthBarrier = {};
+	depthBarrier.sType                = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	depthBarrier.srcAccessMask        = 0;
+	depthBarrier.dstAccessMask        = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	depthBarrier.oldLayout            = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	depthBarrier.newLayout            = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+	depthBarrier.srcQueueFamilyIndex  = VK_QUEUE_FAMILY_IGNORED;
+	depthBarrier.dstQueueFamilyIndex  = VK_QUEUE_FAMILY_IGNORED;
+	depthBarrier.image                = mDepthImage->GetImage();
+	depthBarrier.subresourceRange     = {depthAspectMask, 0, 1, 0, 1};
+
+	vkCmdPipelineBarrier(commandBuffer[index], VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+	                     VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, 0, 0, nullptr, 0, nullptr,
+	                     1, &depthBarrier);
+}
+
+ResourceTable* phx::DepthPyramid::GetResourceTable() const { return mResourceTable.get(); }
+
+uint32_t phx::DepthPyramid::GetLevelCount() const { return mLevelCount; }
+
+void phx::DepthPyramid::CreatePyramid()
+{
+	// The first level matches the depth buffer so no depth sample is lost to rounding, every level after halves it
+	mWidth      = mDepthImage->GetWidth();
+	mHeight     = mDepthImage->GetHeight();
+	mLevelCount = 1;
+
+	while (mLevelCount < MAX_DEPTH_PYRAMID_LEVELS && ((mWidth >> mLevelCount) > 0 || (mHeight >> mLevelCount) > 0))
+	{
+		mLevelCount++;
+	}
+
+	VkImageCreateInfo imageCreateInfo = {};
+	imageCreateInfo.sType             = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageCreateInfo.imageType         = VK_IMAGE_TYPE_2D;
+	imageCreateInfo.extent.width      = mWidth;
+	imageCreateInfo.extent.height     = mHeight;
+	imageCreateInfo.extent.depth      = 1;
+	imageCreateInfo.mipLevels         = mLevelCount;
+	imageCreateInfo.arrayLayers       = 1;
+	imageCreateInfo.format            = VK_FORMAT_R32_SFLOAT;
+	imageCreateInfo.tiling            = VK_IMAGE_TILING_OPTIMAL;
+	imageCreateInfo.initialLayout     = VK_IMAGE_LAYOUT_UNDEFINED;
+	imageCreateInfo.usage             = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	imageCreateInfo.samples           = VK_SAMPLE_COUNT_1_BIT;
+	imageCreateInfo.sharingMode       = VK_SHARING_MODE_EXCLUSIVE;
+
+	mDevice->Validate(vkCreateImage(mDevice->GetDevice(), &imageCreateInfo, nullptr, &mImage));
+
+	VkMemoryRequirements imageMemoryRequirements;
+	vkGetImageMemoryRequirements(mDevice->GetDevice(), mImage, &imageMemoryRequirements);
+
+	mMemoryHeap = std::unique_ptr<MemoryHeap>(
+	    new MemoryHeap(mDevice, static_cast<uint32_t>(imageMemoryRequirements.size), VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+
+	const uint32_t memoryOffset =
+	    mMemoryHeap->Allocate(static_cast<uint32_t>(imageMemoryRequirements.size), static_cast<uint32_t>(imageMemoryRequirements.alignment));
+
+	mDevice->Validate(vkBindImageMemory(mDevice->GetDevice(), mImage, mMemoryHeap->GetMemory()->GetMemory(), memoryOffset));
+
+	VkImageViewCreateInfo imageViewCreateInfo       = {};
+	imageViewCreateInfo.sType                       = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	imageViewCreateInfo.image                       = mImage;
+	imageViewCreateInfo.viewType                    = VK_IMAGE_VIEW_TYPE_2D;
+	imageViewCreateInfo.format                      = VK_FORMAT_R32_SFLOAT;
+	imageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	imageViewCreateInfo.subresourceRange.levelCount = mLevelCount;
+	imageViewCreateInfo.subresourceRange.layerCount = 1;
+
+	mDevice->Validate(vkCreateImageView(mDevice->GetDevice(), &imageViewCreateInfo, nullptr, &mImageView));
+
+	for (uint32_t i = 0; i < mLevelCount; ++i)
+	{
+		imageViewCreateInfo.subresourceRange.baseMipLevel = i;
+		imageViewCreateInfo.subresourceRange.levelCount   = 1;
+
+		mDevice->Validate(vkCreateImageView(mDevice->GetDevice(), &imageViewCreateInfo, nullptr, &mLevelImageViews[i]));
+	}
+
+	VkSamplerCreateInfo samplerCreateInfo = {};
+	samplerCreateInfo.sType               = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerCreateInfo.magFilter           = VK_FILTER_NEAREST;
+	samplerCreateInfo.minFilter           = VK_FILTER_NEAREST;
+	samplerCreateInfo.mipmapMode          = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerCreateInfo.addressModeU        = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.addressModeV        = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.addressModeW        = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerCreateInfo.compareOp           = VK_COMPARE_OP_NEVER;
+	samplerCreateInfo.minLod              = 0.0f;
+	samplerCreateInfo.maxLod              = static_cast<float>(mLevelCount);
+	samplerCreateInfo.maxAnisotropy       = 1.0f;
+	samplerCreateInfo.borderColor         = VK_BORDER_COLOR_FLOAT_OPAQUE_BLACK;
+
+	mDevice->Validate(vkCreateSampler(mDevice->GetDevice(), &samplerCreateInfo, nullptr, &mSampler));
+
+	// The pyramid stays in the general layout, it is written as a storage image and sampled by the next level
+	mDevice->TransitionImageLayout(mImage, imageCreateInfo.format, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_GENERAL,
+	                               {VK_IMAGE_ASPECT_COLOR_BIT, 0, mLevelCount, 0, 1});
+
+	BindReduceResourceTables();
+}
+
+void phx::DepthPyramid::DestroyPyramid()
+{
+	vkDestroySampler(mDevice->GetDevice(), mSampler, nullptr);
+
+	for (uint32_t i = 0; i < mLevelCount; ++i)
+	{
+		vkDestroyImageView(mDevice->GetDevice(), mLevelImageViews[i], nullptr);
+		mLevelImageViews[i] = VK_NULL_HANDLE;
+	}
+
+	vkDestroyImageView(mDevice->GetDevice(), mImageView, nullptr);
+	vkDestroyImage(mDevice->GetDevice(), mImage, nullptr);
+
+	mMemoryHeap.reset();
+}
+
+void phx::DepthPyramid::BindReduceResourceTables()
+{
+	for (uint32_t i = 0; i < mLevelCount; ++i)
+	{
+		// The first level reads the depth attachment, every other level reads the one above it
+		VkDescriptorImageInfo source = {};
+		if (i == 0)
+		{
+			source = mDepthImage->GetDescriptorImageInfo();
+		}
+		else
+		{
+			source.sampler     = mSampler;
+			source.imageView   = mLevelImageViews[i - 1];
+			source.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+		}
+
+		VkDescriptorImageInfo destination = {};
+		destination.imageView             = mLevelImageViews[i];
+		destination.imageLayout           = VK_IMAGE_LAYOUT_GENERAL;
+
+		mReduceResourceTables[i]->Bind(0, source);
+		mReduceResourceTables[i]->Bind(1, destination);
+	}
+
+	VkDescriptorImageInfo pyramid = {};
+	pyramid.sampler               = mSampler;
+	pyramid.imageView             = mImageView;
+	pyramid.imageLayout           = VK_IMAGE_LAYOUT_GENERAL;
+
+	mResourceTable->Bind(0, pyramid);
+}
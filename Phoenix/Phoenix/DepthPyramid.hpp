@@ -0,0 +1,93 @@
+// BSD 3-Clause License
+// 
+// Copyright (c) 2022, Genten Studios
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <memory>
+
+#include <Globals/Globals.hpp>
+
+#include <Renderer/Vulkan.hpp>
+
+class MemoryHeap;
+class RenderDevice;
+class ResourceManager;
+class ResourceTable;
+class Texture;
+
+namespace phx
+{
+	// Hierarchical depth buffer, each level stores the farthest depth of the texels it covers in the level above it.
+	// Built from the depth attachment after the early world pass and sampled by the occlusion culling pass.
+	class DepthPyramid
+	{
+	public:
+		DepthPyramid(RenderDevice* device, ResourceManager* resourceManager, Texture* depthImage);
+
+		~DepthPyramid();
+
+		void ScreenResize(Texture* depthImage);
+
+		// Expects the depth image in VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL and leaves it in the same layout
+		void Build(VkCommandBuffer* commandBuffer, uint32_t index);
+
+		// Combined image sampler of the whole pyramid for the culling shaders
+		ResourceTable* GetResourceTable() const;
+
+		uint32_t GetLevelCount() const;
+
+	private:
+		void CreatePyramid();
+
+		void DestroyPyramid();
+
+		void BindReduceResourceTables();
+
+		RenderDevice*    mDevice;
+		ResourceManager* mResourceManager;
+		Texture*         mDepthImage;
+
+		uint32_t mWidth;
+		uint32_t mHeight;
+		uint32_t mLevelCount;
+
+		std::unique_ptr<MemoryHeap> mMemoryHeap;
+
+		VkImage     mImage     = VK_NULL_HANDLE;
+		VkImageView mImageView = VK_NULL_HANDLE;
+		VkSampler   mSampler   = VK_NULL_HANDLE;
+
+		VkImageView mLevelImageViews[MAX_DEPTH_PYRAMID_LEVELS] = {};
+
+		// Tables can't be returned to the descriptor pool, so they are allocated once for every possible level
+		std::unique_ptr<ResourceTable> mReduceResourceTables[MAX_DEPTH_PYRAMID_LEVELS];
+		std::unique_ptr<ResourceTable> mResourceTable;
+	};
+} // namespace phx
@@ -0,0 +1,192 @@
+// BSD 3-Clause License
+// 
+// Copyright (c) 2022, Genten Studios
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <Phoenix/FrameRecorder.hpp>
+#include <Phoenix/ThreadPool.hpp>
+
+#include <Renderer/Device.hpp>
+#include <Renderer/Renderpass.hpp>
+
+phx::FrameRecorder::FrameRecorder(RenderDevice* device, ThreadPool* threadPool)
+    : mDevice(device), mThreadPool(threadPool), mFrameCount(device->GetSwapchainImageCount())
+{
+	mCommandPools = std::unique_ptr<VkCommandPool[]>(new VkCommandPool[mThreadPool->GetThreadCount()]);
+
+	VkCommandPoolCreateInfo poolInfo = {};
+	poolInfo.sType                   = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.queueFamilyIndex        = mDevice->GetGraphicsQueueFamily();
+	poolInfo.flags                   = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+
+	for (uint32_t i = 0; i < mThreadPool->GetThreadCount(); ++i)
+	{
+		mDevice->Validate(vkCreateCommandPool(mDevice->GetDevice(), &poolInfo, nullptr, &mCommandPools[i]));
+	}
+}
+
+phx::FrameRecorder::~FrameRecorder()
+{
+	// Destroying the pools frees the secondaries allocated from them
+	for (uint32_t i = 0; i < mThreadPool->GetThreadCount(); ++i)
+	{
+		vkDestroyCommandPool(mDevice->GetDevice(), mCommandPools[i], nullptr);
+	}
+}
+
+void phx::FrameRecorder::AddPass(const std::string& name, RenderPass* renderPass, bool dynamic, RecordFunction record)
+{
+	Pass pass;
+	pass.name        = name;
+	pass.renderPass  = renderPass;
+	pass.dynamic     = dynamic;
+	pass.record      = std::move(record);
+	pass.threadIndex = static_cast<uint32_t>(mPasses.size()) % mThreadPool->GetThreadCount();
+
+	pass.commandBuffers = std::unique_ptr<VkCommandBuffer[]>(new VkCommandBuffer[mFrameCount]);
+	pass.recorded       = std::unique_ptr<bool[]>(new bool[mFrameCount]);
+
+	VkCommandBufferAllocateInfo commandBufferAllocateInfo = {};
+	commandBufferAllocateInfo.sType                       = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	commandBufferAllocateInfo.commandPool                 = mCommandPools[pass.threadIndex];
+	commandBufferAllocateInfo.level                       = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+	commandBufferAllocateInfo.commandBufferCount          = mFrameCount;
+
+	mDevice->Validate(vkAllocateCommandBuffers(mDevice->GetDevice(), &commandBufferAllocateInfo, pass.commandBuffers.get()));
+
+	for (uint32_t i = 0; i < mFrameCount; ++i)
+	{
+		pass.recorded[i] = false;
+	}
+
+	mPasses.push_back(std::move(pass));
+}
+
+void phx::FrameRecorder::Invalidate()
+{
+	for (Pass& pass : mPasses)
+	{
+		for (uint32_t i = 0; i < mFrameCount; ++i)
+		{
+			pass.recorded[i] = false;
+		}
+	}
+}
+
+void phx::FrameRecorder::Record(uint32_t index)
+{
+	mPendingPasses.clear();
+	for (Pass& pass : mPasses)
+	{
+		if (pass.dynamic || !pass.recorded[index])
+		{
+			mPendingPasses.push_back(&pass);
+		}
+	}
+
+	// Task i runs on worker i % thread count, so there is one task per worker and each only records the passes of its pool
+	mThreadPool->Dispatch(mPendingPasses.empty() ? 0 : mThreadPool->GetThreadCount(), [this, index](uint32_t, uint32_t threadIndex) {
+		for (Pass* pass : mPendingPasses)
+		{
+			if (pass->threadIndex == threadIndex)
+			{
+				RecordPass(*pass, index);
+			}
+		}
+	});
+
+	VkCommandBuffer* commandBuffers = mDevice->GetPrimaryCommandBuffers();
+
+	mDevice->Validate(vkResetCommandBuffer(commandBuffers[index], 0));
+
+	mDevice->BeginCommand(commandBuffers[index], VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT);
+
+	RenderPass* activeRenderPass = nullptr;
+	for (Pass& pass : mPasses)
+	{
+		if (pass.renderPass != activeRenderPass)
+		{
+			if (activeRenderPass != nullptr)
+			{
+				vkCmdEndRenderPass(commandBuffers[index]);
+			}
+
+			if (pass.renderPass != nullptr)
+			{
+				pass.renderPass->Use(commandBuffers, index, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+			}
+
+			activeRenderPass = pass.renderPass;
+		}
+
+		vkCmdExecuteCommands(commandBuffers[index], 1, &pass.commandBuffers[index]);
+	}
+
+	if (activeRenderPass != nullptr)
+	{
+		vkCmdEndRenderPass(commandBuffers[index]);
+	}
+
+	mDevice->Validate(vkEndCommandBuffer(commandBuffers[index]));
+}
+
+void phx::FrameRecorder::RecordPass(Pass& pass, uint32_t index)
+{
+	VkCommandBuffer commandBuffer = pass.commandBuffers[index];
+
+	mDevice->Validate(vkResetCommandBuffer(commandBuffer, 0));
+
+	VkCommandBufferInheritanceInfo inheritanceInfo = {};
+	inheritanceInfo.sType                          = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+
+	VkCommandBufferBeginInfo commandBufferBeginInfo = {};
+	commandBufferBeginInfo.sType                    = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	commandBufferBeginInfo.pInheritanceInfo         = &inheritanceInfo;
+
+	if (pass.renderPass != nullptr)
+	{
+		inheritanceInfo.renderPass  = pass.renderPass->GetRenderPass();
+		inheritanceInfo.subpass     = 0;
+		inheritanceInfo.framebuffer = pass.renderPass->GetFrameBuffers()[index];
+
+		commandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT;
+	}
+
+	if (pass.dynamic)
+	{
+		commandBufferBeginInfo.flags |= VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	}
+
+	mDevice->Validate(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
+
+	pass.record(pass.commandBuffers.get(), index);
+
+	mDevice->Validate(vkEndCommandBuffer(commandBuffer));
+
+	pass.recorded[index] = true;
+}
@@ -0,0 +1,99 @@
+// BSD 3-Clause License
+// 
+// Copyright (c) 2022, Genten Studios
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <Renderer/Vulkan.hpp>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+class RenderDevice;
+class RenderPass;
+
+namespace phx
+{
+	class ThreadPool;
+
+	// Records the frame's primary command buffer every frame out of a list of passes. Each pass lives in its own secondary
+	// command buffer per swapchain image, dynamic passes are re-recorded every frame and stable ones only after Invalidate.
+	// Secondaries are recorded in parallel on the thread pool, every worker owning the command pool its passes come from.
+	class FrameRecorder
+	{
+	public:
+		// Records the pass into commandBuffers[index], render pass passes have to set their own viewport and scissor
+		using RecordFunction = std::function<void(VkCommandBuffer* commandBuffers, uint32_t index)>;
+
+		FrameRecorder(RenderDevice* device, ThreadPool* threadPool);
+
+		~FrameRecorder();
+
+		// Passes run in the order they are added. Passes with a render pass are executed inside it, consecutive passes
+		// sharing the same render pass share one instance of it. Passes without one run outside any render pass.
+		void AddPass(const std::string& name, RenderPass* renderPass, bool dynamic, RecordFunction record);
+
+		// Stable passes are re-recorded by the next Record, needed whenever what they reference is recreated
+		void Invalidate();
+
+		// Records the primary command buffer of the swapchain image, its previous submission must have completed
+		void Record(uint32_t index);
+
+	private:
+		struct Pass
+		{
+			std::string    name;
+			RenderPass*    renderPass;
+			bool           dynamic;
+			RecordFunction record;
+
+			// Worker that records the pass, the secondaries come from that worker's command pool
+			uint32_t threadIndex;
+
+			std::unique_ptr<VkCommandBuffer[]> commandBuffers;
+			std::unique_ptr<bool[]>            recorded;
+		};
+
+		void RecordPass(Pass& pass, uint32_t index);
+
+		RenderDevice* mDevice;
+		ThreadPool*   mThreadPool;
+
+		uint32_t mFrameCount;
+
+		std::unique_ptr<VkCommandPool[]> mCommandPools;
+
+		std::vector<Pass> mPasses;
+
+		// Passes that need recording this frame, reused to avoid allocating every frame
+		std::vector<Pass*> mPendingPasses;
+	};
+} // namespace phx
@@ -50,10 +50,14 @@ phx::ModHandler::ModHandler(unsigned modCount)
 	Mod* core = &m_mods[m_currentLookupIndex];
 	core->blocks.AllocateMemory(2);
 
-	core->blocks.AddBlock("core.air", "Air", "");
-	core->blocks.AddBlock("core.unknown", "Unknown", "");
+	core->blocks.AddBlock("air", "Air", "");
+	core->blocks.AddBlock("unknown", "Unknown", "");
 
 	core->lookupIndex = 0;
+	core->name        = "core";
+
+	m_modNameLookup[core->name] = core->lookupIndex;
+	IndexBlocks(*core);
 
 	++m_currentLookupIndex;
 }
@@ -67,24 +71,22 @@ phx::Block* phx::ModHandler::GetBlock(ChunkBlock block) const
 	return mod->blocks.GetBlock(block.val.blockID);
 }
 
-phx::Block* phx::ModHandler::GetBlock(const std::string& block) const
+phx::Block* phx::ModHandler::GetBlock(std::string_view block) const
 {
-	// Split by the first period.
-	int pos = 0;
-	while (block[pos] != '.')
-		++pos;
-
-	if (pos == block.size() - 1)
+	const auto it = m_blockLookup.find(block);
+	if (it == m_blockLookup.end())
 		return nullptr;
 
-	const std::string modName   = block.substr(0, pos);
-	const std::string blockName = block.substr(pos + 1);
+	return GetBlock(it->second);
+}
 
-	const Mod* mod = GetMod(modName);
-	if (!mod)
-		return nullptr;
+phx::ChunkBlock phx::ModHandler::GetChunkBlock(std::string_view block) const
+{
+	const auto it = m_blockLookup.find(block);
+	if (it == m_blockLookup.end())
+		return ChunkBlock(GetCoreModID(), GetUnknownBlockID(), 0);
 
-	return mod->blocks.GetBlock(blockName);
+	return it->second;
 }
 
 phx::Mod* phx::ModHandler::AddMod(const std::filesystem::path& modXMLPath)
@@ -194,9 +196,13 @@ phx::Mod* phx::ModHandler::AddMod(const std::filesystem::path& modXMLPath)
 		}
 	}
 
-	m_modNameLookup[mod.name] = m_currentLookupIndex;
 	m_mods[m_currentLookupIndex] = std::move(mod);
 
+	// Keyed by the stored copy, the moved from name is gone
+	const Mod& stored            = m_mods[m_currentLookupIndex];
+	m_modNameLookup[stored.name] = m_currentLookupIndex;
+	IndexBlocks(stored);
+
 	return &m_mods[m_currentLookupIndex++];
 }
 
@@ -208,7 +214,7 @@ phx::Mod* phx::ModHandler::GetMod(int lookupIndex) const
 	return &m_mods[lookupIndex];
 }
 
-phx::Mod* phx::ModHandler::GetMod(const std::string& modName) const
+phx::Mod* phx::ModHandler::GetMod(std::string_view modName) const
 {
 	const auto it = m_modNameLookup.find(modName);
 	if (it == m_modNameLookup.end())
@@ -223,3 +229,15 @@ phx::Mod* phx::ModHandler::GetMods() { return m_mods.get(); }
 
 const std::vector<std::string>& phx::ModHandler::GetSkyboxTextures() const { return m_skyboxTextures; }
 
+void phx::ModHandler::IndexBlocks(const Mod& mod)
+{
+	const Block* blocks = mod.blocks.GetBlocks();
+
+	for (uint16_t i = 0; i < mod.blocks.GetBlockCount(); i++)
+	{
+		const std::string& name = m_qualifiedBlockNames.emplace_back(mod.name + "." + blocks[i].name);
+
+		m_blockLookup[name] = ChunkBlock(mod.lookupIndex, blocks[i].lookupIndex, 0);
+	}
+}
+
@@ -32,7 +32,9 @@
 
 #include <Phoenix/Blocks.hpp>
 
+#include <deque>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <filesystem>
 #include <unordered_map>
@@ -60,18 +62,27 @@ namespace phx
 		static constexpr uint16_t   GetUnknownBlockID() { return 1; }
 
 		Block* GetBlock(ChunkBlock block) const;
-		Block* GetBlock(const std::string& block) const;
+
+		// Takes a qualified "mod.block" name, found with a single hash lookup and no allocations
+		Block* GetBlock(std::string_view block) const;
+
+		// core.unknown when no block has that qualified name
+		ChunkBlock GetChunkBlock(std::string_view block) const;
 
 		Mod* AddMod(const std::filesystem::path& modXMLPath);
 
 		Mod* GetMod(int lookupIndex) const;
-		Mod* GetMod(const std::string& modName) const;
+		Mod* GetMod(std::string_view modName) const;
 
 		uint16_t GetModCount();
 		Mod*     GetMods();
 
 		const std::vector<std::string>& GetSkyboxTextures() const;
 
+	private:
+		// Adds the qualified names of every block of the mod to m_blockLookup
+		void IndexBlocks(const Mod& mod);
+
 	private:
 		std::unique_ptr<Mod[]> m_mods;
 		uint16_t               m_currentLookupIndex = 0;
@@ -79,8 +90,12 @@ namespace phx
 		// temporary way of registering skybox textures.
 		std::vector<std::string> m_skyboxTextures;
 
-		// @todo Replace this with something more performant.
-		std::unordered_map<std::string, uint16_t> m_modNameLookup;
+		// Keys view the names of the mods in m_mods, which never move once added
+		std::unordered_map<std::string_view, uint16_t> m_modNameLookup;
+
+		// Every block by "mod.block". The deque owns the qualified names and never moves them, so the keys can view them.
+		std::deque<std::string>                          m_qualifiedBlockNames;
+		std::unordered_map<std::string_view, ChunkBlock> m_blockLookup;
 	};
 } // namespace phx
 
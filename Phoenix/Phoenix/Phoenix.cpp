@@ -30,10 +30,14 @@
 
 #include <Phoenix/Phoenix.hpp>
 
+#include <Phoenix/BlockStates.hpp>
 #include <Phoenix/DebugUI.hpp>
 #include <Phoenix/DebugWindows.hpp>
+#include <Phoenix/DepthPyramid.hpp>
+#include <Phoenix/FrameRecorder.hpp>
 #include <Phoenix/InputHandler.hpp>
 #include <Phoenix/Mods.hpp>
+#include <Phoenix/ThreadPool.hpp>
 #include <Phoenix/World.hpp>
 
 #include <Renderer/Buffer.hpp>
@@ -107,8 +111,11 @@ phx::Phoenix::Phoenix(Window* window) : mWindow(window)
 	CreateCameraBuffer();
 	InitCamera();
 	InitMods();
+	InitThreadPool();
 	InitWorld();
+	InitDepthPyramid();
 	InitDebugUI();
+	InitFrameRecorder();
 	InitInputHandler();
 	InitTexturePool();
 	InitDefaultTextures();
@@ -130,79 +137,86 @@ phx::Phoenix::~Phoenix()
 
 	mWorld.reset();
 
+	mDepthPyramid.reset();
+
 	mDebugUI.reset();
 
+	mFrameRecorder.reset();
+
+	mThreadPool.reset();
+
 	mInputHandler.reset();
 
 	mDevice.reset();
 }
 
-void phx::Phoenix::RebuildCommandBuffers()
-{
-	VkViewport viewport = {};
-	viewport.x          = 0;
-	viewport.y          = 0;
-	viewport.width      = static_cast<float>(mWindow->GetWidth());
-	viewport.height     = static_cast<float>(mWindow->GetHeight());
-	viewport.minDepth   = 0.0f;
-	viewport.maxDepth   = 1.0f;
-
-	VkRect2D scissor {};
-	scissor.extent.width  = mWindow->GetWidth();
-	scissor.extent.height = mWindow->GetHeight();
-	scissor.offset.x      = 0;
-	scissor.offset.y      = 0;
-
-	// Make a basic command buffer
-	VkCommandBuffer* commandBuffers = mDevice->GetPrimaryCommandBuffers();
-	for (uint32_t i = 0; i < mDevice->GetSwapchainImageCount(); i++)
-	{
-
-		mDevice->Validate(vkResetCommandBuffer(commandBuffers[i], 0));
-
-		mDevice->BeginCommand(commandBuffers[i], VK_COMMAND_BUFFER_USAGE_SIMULTANEOUS_USE_BIT);
-
-		mWorld->ComputeVisibility(commandBuffers, i);
-
-		{
-			mPrimaryRenderTarget->GetRenderPass()->Use(commandBuffers, i);
-
-			vkCmdSetViewport(commandBuffers[i], 0, 1, &viewport);
-
-			vkCmdSetScissor(commandBuffers[i], 0, 1, &scissor);
-
-			mWorld->Draw(commandBuffers, i);
-
-			mDebugUI->Use(commandBuffers, i, true);
+void phx::Phoenix::RebuildCommandBuffers() { mFrameRecorder->Invalidate(); }
 
-			vkCmdEndRenderPass(commandBuffers[i]);
-		}
+void phx::Phoenix::InitThreadPool()
+{
+	mThreadPool = std::unique_ptr<ThreadPool>(new ThreadPool());
+	mResourceManager->RegisterResource("ThreadPool", mThreadPool.get(), false);
+}
 
-		RenderTarget* src = mPrimaryRenderTarget;
-
-		mDevice->TransitionImageLayout(commandBuffers[i], mDevice->GetSwapchainImages()[i], mDevice->GetSurfaceFormat(),
-		                               VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-		                               {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1});
-		src->GetImage()->TransitionImageLayout(commandBuffers[i], VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-		                                       VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
-
-		VkImageCopy copyRegion {};
-		copyRegion.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
-		copyRegion.srcOffset      = {0, 0, 0};
-		copyRegion.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
-		copyRegion.dstOffset      = {0, 0, 0};
-		copyRegion.extent         = {mDevice->GetWindowWidth(), mDevice->GetWindowHeight(), 1};
-		vkCmdCopyImage(commandBuffers[i], src->GetImage()->GetImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-		               mDevice->GetSwapchainImages()[i], VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copyRegion);
-
-		src->GetImage()->TransitionImageLayout(commandBuffers[i], VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
-		                                       VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
-		mDevice->TransitionImageLayout(commandBuffers[i], mDevice->GetSwapchainImages()[i], mDevice->GetSurfaceFormat(),
-		                               VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
-		                               {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1});
-
-		mDevice->Validate(vkEndCommandBuffer(commandBuffers[i]));
-	}
+void phx::Phoenix::InitFrameRecorder()
+{
+	mFrameRecorder = std::unique_ptr<FrameRecorder>(new FrameRecorder(mDevice.get(), mThreadPool.get()));
+
+	// Secondaries don't inherit dynamic state, so every pass inside a render pass sets its own
+	auto useFullViewport = [this](VkCommandBuffer* commandBuffers, uint32_t i) {
+		VkViewport viewport = {};
+		viewport.x          = 0;
+		viewport.y          = 0;
+		viewport.width      = static_cast<float>(mWindow->GetWidth());
+		viewport.height     = static_cast<float>(mWindow->GetHeight());
+		viewport.minDepth   = 0.0f;
+		viewport.maxDepth   = 1.0f;
+
+		VkRect2D scissor {};
+		scissor.extent.width  = mWindow->GetWidth();
+		scissor.extent.height = mWindow->GetHeight();
+		scissor.offset.x      = 0;
+		scissor.offset.y      = 0;
+
+		vkCmdSetViewport(commandBuffers[i], 0, 1, &viewport);
+
+		vkCmdSetScissor(commandBuffers[i], 0, 1, &scissor);
+	};
+
+	RenderPass* clearRenderPass = mPrimaryRenderTarget->GetRenderPass();
+	RenderPass* loadRenderPass  = mPrimaryRenderTarget->GetLoadRenderPass();
+
+	// Culling and world passes follow what is visible, so they are recorded every frame
+	mFrameRecorder->AddPass("Early Culling", nullptr, true, [this](VkCommandBuffer* commandBuffers, uint32_t i) {
+		mWorld->ComputeVisibility(commandBuffers, i, World::Early);
+	});
+
+	mFrameRecorder->AddPass("Early World", clearRenderPass, true, [this, useFullViewport](VkCommandBuffer* commandBuffers, uint32_t i) {
+		useFullViewport(commandBuffers, i);
+		mWorld->Draw(commandBuffers, i, World::Early);
+	});
+
+	mFrameRecorder->AddPass("Depth Pyramid", nullptr, false, [this](VkCommandBuffer* commandBuffers, uint32_t i) {
+		mDepthPyramid->Build(commandBuffers, i);
+	});
+
+	mFrameRecorder->AddPass("Late Culling", nullptr, true, [this](VkCommandBuffer* commandBuffers, uint32_t i) {
+		mWorld->ComputeVisibility(commandBuffers, i, World::Late);
+	});
+
+	mFrameRecorder->AddPass("Late World", loadRenderPass, true, [this, useFullViewport](VkCommandBuffer* commandBuffers, uint32_t i) {
+		useFullViewport(commandBuffers, i);
+		mWorld->Draw(commandBuffers, i, World::Late);
+	});
+
+	mFrameRecorder->AddPass("Skybox", loadRenderPass, false, [this, useFullViewport](VkCommandBuffer* commandBuffers, uint32_t i) {
+		useFullViewport(commandBuffers, i);
+		mWorld->DrawSkybox(commandBuffers, i);
+	});
+
+	mFrameRecorder->AddPass("DebugUI", loadRenderPass, true, [this](VkCommandBuffer* commandBuffers, uint32_t i) {
+		mDebugUI->Use(commandBuffers, i, true);
+	});
 }
 
 void phx::Phoenix::Update()
@@ -210,15 +224,17 @@ void phx::Phoenix::Update()
 	UpdateCamera();
 	mWorld->Update();
 
+	// The UI streams into the ring slice of the image this frame is presented to
+	mDevice->AcquireNextImage();
+
 	mStatisticManager.StartStatistic("ImGui");
 	// Temp delta time
 	mDebugUI->Update(mDeltaTime);
 	mStatisticManager.StopStatistic("ImGui");
 
-	if (mDebugUI->IsCMDOutdated())
-	{
-		RebuildCommandBuffers();
-	}
+	mStatisticManager.StartStatistic("Record");
+	mFrameRecorder->Record(mDevice->GetSwapchainImageIndex());
+	mStatisticManager.StopStatistic("Record");
 
 	mStatisticManager.StartStatistic("Render");
 	mDevice->Present();
@@ -343,13 +359,15 @@ void phx::Phoenix::UpdateCamera()
 void phx::Phoenix::RebuildRenderPassResources()
 {
 	mPrimaryRenderTarget->ScreenResize(mDevice->GetWindowWidth(), mDevice->GetWindowHeight());
+	mDepthPyramid->ScreenResize(mPrimaryRenderTarget->GetDepthImage());
 }
 
 void phx::Phoenix::CreateRenderPassResource()
 {
 	if (mPrimaryRenderTarget == nullptr)
 	{
-		mPrimaryRenderTarget = new RenderTarget(mDevice.get(), mDevice->GetWindowWidth(), mDevice->GetWindowHeight(), true);
+		// The frame is drawn straight into the swapchain images, so the primary target only owns a depth image
+		mPrimaryRenderTarget = new RenderTarget(mDevice.get(), mDevice->GetWindowWidth(), mDevice->GetWindowHeight(), true, true);
 		mResourceManager->RegisterResource<RenderTarget>(mPrimaryRenderTarget);
 	}
 	else
@@ -399,6 +417,13 @@ void phx::Phoenix::InitWorld()
 	mResourceManager->RegisterResource("World", mWorld.get(), false);
 }
 
+void phx::Phoenix::InitDepthPyramid()
+{
+	mDepthPyramid = std::unique_ptr<DepthPyramid>(
+	    new DepthPyramid(mDevice.get(), mResourceManager.get(), mPrimaryRenderTarget->GetDepthImage()));
+	mResourceManager->RegisterResource("DepthPyramid", mDepthPyramid.get(), false);
+}
+
 void phx::Phoenix::InitMods()
 {
 	int modCount = 1;
@@ -407,6 +432,10 @@ void phx::Phoenix::InitMods()
 	mResourceManager->RegisterResource("ModHandler", mMods.get(), false);
 
 	mMods->AddMod("mods/standard_blocks-0.1/standard_blocks.xml");
+
+	mBlockStates = std::unique_ptr<BlockStateRegistry>(new BlockStateRegistry(mMods.get()));
+	mBlockStates->RegisterModBlocks();
+	mResourceManager->RegisterResource("BlockStateRegistry", mBlockStates.get(), false);
 }
 
 void phx::Phoenix::InitDebugUI()
@@ -498,6 +527,9 @@ void phx::Phoenix::InitDefaultTextures()
 		}
 	}
 
+	// The block states were registered before the textures had layers
+	mBlockStates->RefreshTextures();
+
 	// Load skybox textures.
 	uint32_t                   width, height;
 	std::vector<unsigned char> outputBuffer;
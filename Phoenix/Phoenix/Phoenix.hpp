@@ -61,8 +61,12 @@ class DebugUI;
 namespace phx
 {
 	class World;
+	class DepthPyramid;
+	class FrameRecorder;
+	class ThreadPool;
 	class InputHandler;
 	class ModHandler;
+	class BlockStateRegistry;
 
 	class Phoenix
 	{
@@ -71,6 +75,7 @@ namespace phx
 
 		~Phoenix();
 
+		// Frames are recorded every frame, this only makes the passes cached by the frame recorder record again
 		void RebuildCommandBuffers();
 
 		void Update();
@@ -104,12 +109,18 @@ namespace phx
 
 		void InitCamera();
 
+		void InitThreadPool();
+
 		void InitWorld();
 
+		void InitDepthPyramid();
+
 		void InitMods();
 
 		void InitDebugUI();
 
+		void InitFrameRecorder();
+
 		void InitInputHandler();
 
 		void InitTexturePool();
@@ -122,9 +133,13 @@ namespace phx
 		std::unique_ptr<ResourceManager> mResourceManager;
 
 		std::unique_ptr<World> mWorld;
+		std::unique_ptr<DepthPyramid> mDepthPyramid;
 		std::unique_ptr<ModHandler> mMods;
+		std::unique_ptr<BlockStateRegistry> mBlockStates;
 
 		std::unique_ptr<DebugUI> mDebugUI;
+		std::unique_ptr<ThreadPool> mThreadPool;
+		std::unique_ptr<FrameRecorder> mFrameRecorder;
 		std::unique_ptr<InputHandler> mInputHandler;
 		
 		std::unique_ptr<MemoryHeap> mDeviceLocalMemoryHeap;
@@ -0,0 +1,590 @@
+// BSD 3-Clause License
+// 
+// Copyright (c) 2022, Genten Studios
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <Phoenix/RegionStore.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+#ifdef _WIN32
+#	define NOMINMAX
+#	include <windows.h>
+#else
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+static const char     REGION_MAGIC[4] = {'P', 'H', 'X', 'R'};
+static const uint32_t REGION_VERSION  = 2;
+
+static_assert(MAX_BLOCKS_PER_CHUNK <= 0xFFFF, "Run lengths are stored in 16 bits");
+
+// A region is compacted once dead records make up more than half of it, and at least this many bytes
+static const uint64_t REGION_COMPACT_MIN_DEAD_BYTES = 1 << 20;
+
+// Record offsets are 32 bit, a region never grows past this
+static const uint64_t REGION_MAX_FILE_SIZE = UINT32_MAX;
+
+template <typename T>
+static void Append(std::vector<uint8_t>& record, const T& value)
+{
+	const size_t offset = record.size();
+	record.resize(offset + sizeof(T));
+	memcpy(record.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+static bool Read(const uint8_t*& record, const uint8_t* end, T& value)
+{
+	if (static_cast<size_t>(end - record) < sizeof(T))
+		return false;
+
+	memcpy(&value, record, sizeof(T));
+	record += sizeof(T);
+	return true;
+}
+
+static uint32_t RegionEntryIndex(glm::ivec3 chunkPosition)
+{
+	const glm::ivec3 local = chunkPosition & static_cast<int>(phx::REGION_CHUNK_BIT_SIZE_MASK);
+	return local.x + (local.y * phx::REGION_CHUNKS_PER_AXIS) + (local.z * phx::REGION_CHUNKS_PER_AXIS * phx::REGION_CHUNKS_PER_AXIS);
+}
+
+static uint64_t MicrosecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+phx::RegionStore::RegionStore(std::string directory) : mDirectory(directory)
+{
+	std::error_code error;
+	std::filesystem::create_directories(mDirectory, error);
+
+	mWriter = std::thread(&RegionStore::WriterLoop, this);
+}
+
+phx::RegionStore::~RegionStore()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+	mWorkAvailable.notify_all();
+
+	mWriter.join();
+
+	for (auto& it : mMappings)
+	{
+		UnmapRegion(it.second);
+	}
+}
+
+void phx::RegionStore::SaveChunk(glm::ivec3 chunkPosition, const ChunkBlock* blocks)
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mPendingSaves[PackPosition(chunkPosition)].assign(blocks, blocks + MAX_BLOCKS_PER_CHUNK);
+	}
+	mWorkAvailable.notify_one();
+}
+
+bool phx::RegionStore::LoadChunk(glm::ivec3 chunkPosition, ChunkBlock* blocks)
+{
+	const uint64_t key = PackPosition(chunkPosition);
+
+	// Anything not yet written is newer than what is on disk
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+
+		for (const std::map<uint64_t, std::vector<ChunkBlock>>* saves : {&mPendingSaves, &mWritingSaves})
+		{
+			auto it = saves->find(key);
+			if (it != saves->end())
+			{
+				memcpy(blocks, it->second.data(), sizeof(ChunkBlock) * MAX_BLOCKS_PER_CHUNK);
+				return true;
+			}
+		}
+	}
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	const glm::ivec3 regionPosition = chunkPosition >> static_cast<int>(REGION_CHUNK_BIT_SIZE);
+
+	bool loaded = false;
+	{
+		std::lock_guard<std::mutex> fileLock(mFileMutex);
+
+		RegionMapping& mapping = mMappings[PackPosition(regionPosition)];
+
+		if (mapping.data == nullptr && !MapRegion(regionPosition, mapping))
+		{
+			mMappings.erase(PackPosition(regionPosition));
+			return false;
+		}
+
+		const RegionHeader* header = reinterpret_cast<const RegionHeader*>(mapping.data);
+		const RegionEntry&  entry  = header->entries[RegionEntryIndex(chunkPosition)];
+
+		if (entry.offset == 0 || static_cast<size_t>(entry.offset) + entry.size > mapping.size)
+			return false;
+
+		loaded = Decompress(mapping.data + entry.offset, entry.size, blocks);
+	}
+
+	if (loaded)
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mChunksLoaded++;
+		mLoadMicroseconds += MicrosecondsSince(start);
+	}
+
+	return loaded;
+}
+
+void phx::RegionStore::Flush()
+{
+	std::unique_lock<std::mutex> lock(mMutex);
+	mWorkFinished.wait(lock, [this] { return mPendingSaves.empty() && mWritingSaves.empty(); });
+}
+
+float phx::RegionStore::GetSaveChunksPerSecond()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mSaveMicroseconds == 0 ? 0.0f : static_cast<float>(mChunksSaved) * 1000000.0f / static_cast<float>(mSaveMicroseconds);
+}
+
+float phx::RegionStore::GetLoadChunksPerSecond()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	return mLoadMicroseconds == 0 ? 0.0f : static_cast<float>(mChunksLoaded) * 1000000.0f / static_cast<float>(mLoadMicroseconds);
+}
+
+void phx::RegionStore::WriterLoop()
+{
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mWorkAvailable.wait(lock, [this] { return mStopping || !mPendingSaves.empty(); });
+
+			// Only stop once everything queued has been written
+			if (mPendingSaves.empty())
+				return;
+
+			// Saves keep queueing up behind this batch while it is written, so a busy chunk is written once per batch
+			mWritingSaves.swap(mPendingSaves);
+		}
+
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		// Each region file is opened and its table rewritten once for all of its chunks in the batch
+		std::map<uint64_t, std::vector<ChunkSave>> regions;
+		for (auto& it : mWritingSaves)
+		{
+			const glm::ivec3 chunkPosition  = UnpackPosition(it.first);
+			const glm::ivec3 regionPosition = chunkPosition >> static_cast<int>(REGION_CHUNK_BIT_SIZE);
+
+			regions[PackPosition(regionPosition)].push_back(ChunkSave(chunkPosition, &it.second));
+		}
+
+		for (auto& it : regions)
+		{
+			WriteRegion(UnpackPosition(it.first), it.second);
+		}
+
+		const uint64_t elapsed = MicrosecondsSince(start);
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mChunksSaved += mWritingSaves.size();
+			mSaveMicroseconds += elapsed;
+			mWritingSaves.clear();
+		}
+		mWorkFinished.notify_all();
+	}
+}
+
+void phx::RegionStore::WriteRegion(glm::ivec3 regionPosition, const std::vector<ChunkSave>& chunks)
+{
+	const std::string path = GetRegionPath(regionPosition);
+
+	std::unique_ptr<RegionHeader> header = std::unique_ptr<RegionHeader>(new RegionHeader());
+
+	std::lock_guard<std::mutex> fileLock(mFileMutex);
+
+	// The file is about to change underneath the mapping, the next load maps it again
+	auto mapping = mMappings.find(PackPosition(regionPosition));
+	if (mapping != mMappings.end())
+	{
+		UnmapRegion(mapping->second);
+		mMappings.erase(mapping);
+	}
+
+	std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+
+	if (file.is_open())
+	{
+		file.read(reinterpret_cast<char*>(header.get()), sizeof(RegionHeader));
+	}
+
+	if (!file.is_open() || !file || memcmp(header->magic, REGION_MAGIC, sizeof(REGION_MAGIC)) != 0 ||
+	    header->version != REGION_VERSION || header->chunkBlockBitSize != CHUNK_BLOCK_BIT_SIZE)
+	{
+		// Missing or unreadable, start the region over
+		file.close();
+		file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+
+		memset(header.get(), 0, sizeof(RegionHeader));
+		memcpy(header->magic, REGION_MAGIC, sizeof(REGION_MAGIC));
+		header->version           = REGION_VERSION;
+		header->chunkBlockBitSize = CHUNK_BLOCK_BIT_SIZE;
+
+		file.write(reinterpret_cast<const char*>(header.get()), sizeof(RegionHeader));
+	}
+
+	if (!file)
+		return;
+
+	file.seekp(0, std::ios::end);
+	uint64_t fileSize = static_cast<uint64_t>(file.tellp());
+
+	// Whatever the table does not point at is left over from earlier saves
+	uint64_t liveBytes = 0;
+	for (const RegionEntry& entry : header->entries)
+	{
+		liveBytes += entry.size;
+	}
+
+	std::vector<std::vector<uint8_t>> records(chunks.size());
+	uint64_t                          recordBytes = 0;
+
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		Compress(chunks[i].second->data(), records[i]);
+		recordBytes += records[i].size();
+	}
+
+	// Make room before the offsets would wrap
+	if (fileSize + recordBytes > REGION_MAX_FILE_SIZE && CompactRegion(path, file, header.get()))
+	{
+		fileSize = sizeof(RegionHeader) + liveBytes;
+	}
+
+	uint64_t deadBytes = fileSize - sizeof(RegionHeader) - liveBytes;
+
+	for (size_t i = 0; i < chunks.size(); i++)
+	{
+		const std::vector<uint8_t>& record = records[i];
+		const uint32_t              size   = static_cast<uint32_t>(record.size());
+
+		RegionEntry& entry = header->entries[RegionEntryIndex(chunks[i].first)];
+
+		if (entry.offset != 0 && size <= entry.size)
+		{
+			// The tail of the old record becomes dead space
+			file.seekp(entry.offset, std::ios::beg);
+			deadBytes += entry.size - size;
+		}
+		else
+		{
+			// Even a compacted region is full, the chunk keeps its last record
+			if (fileSize + size > REGION_MAX_FILE_SIZE)
+				continue;
+
+			file.seekp(0, std::ios::end);
+			deadBytes += entry.size;
+
+			entry.offset = static_cast<uint32_t>(fileSize);
+			fileSize += size;
+		}
+
+		file.write(reinterpret_cast<const char*>(record.data()), size);
+		entry.size = size;
+	}
+
+	// The table goes last, so a failed append leaves the previous record in use. Records rewritten in place have no
+	// such protection.
+	file.seekp(0, std::ios::beg);
+	file.write(reinterpret_cast<const char*>(header.get()), sizeof(RegionHeader));
+
+	if (deadBytes >= REGION_COMPACT_MIN_DEAD_BYTES && deadBytes * 2 > fileSize)
+	{
+		CompactRegion(path, file, header.get());
+	}
+}
+
+bool phx::RegionStore::CompactRegion(const std::string& path, std::fstream& file, RegionHeader* header)
+{
+	const std::string compactPath = path + ".tmp";
+
+	std::unique_ptr<RegionHeader> compacted = std::unique_ptr<RegionHeader>(new RegionHeader(*header));
+
+	std::fstream output(compactPath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+	// Written again once the offsets are known
+	output.write(reinterpret_cast<const char*>(compacted.get()), sizeof(RegionHeader));
+
+	uint32_t          offset = sizeof(RegionHeader);
+	std::vector<char> record;
+
+	for (RegionEntry& entry : compacted->entries)
+	{
+		if (entry.offset == 0)
+			continue;
+
+		record.resize(entry.size);
+
+		file.seekg(entry.offset, std::ios::beg);
+		file.read(record.data(), entry.size);
+		output.write(record.data(), entry.size);
+
+		entry.offset = offset;
+		offset += entry.size;
+	}
+
+	output.seekp(0, std::ios::beg);
+	output.write(reinterpret_cast<const char*>(compacted.get()), sizeof(RegionHeader));
+
+	const bool written = file && output;
+
+	output.close();
+	file.close();
+
+	std::error_code error;
+	if (written)
+	{
+		std::filesystem::rename(compactPath, path, error);
+	}
+
+	if (!written || error)
+	{
+		std::filesystem::remove(compactPath, error);
+		file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+		return false;
+	}
+
+	file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+	*header = *compacted;
+
+	return true;
+}
+
+std::string phx::RegionStore::GetRegionPath(glm::ivec3 regionPosition) const
+{
+	return mDirectory + "/r." + std::to_string(regionPosition.x) + "." + std::to_string(regionPosition.y) + "." +
+	       std::to_string(regionPosition.z) + ".phr";
+}
+
+bool phx::RegionStore::MapRegion(glm::ivec3 regionPosition, RegionMapping& mapping)
+{
+	const std::string path = GetRegionPath(regionPosition);
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING,
+	                          FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || static_cast<size_t>(fileSize.QuadPart) < sizeof(RegionHeader))
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE fileMapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (fileMapping == nullptr)
+	{
+		CloseHandle(file);
+		return false;
+	}
+
+	const void* data = MapViewOfFile(fileMapping, FILE_MAP_READ, 0, 0, 0);
+	if (data == nullptr)
+	{
+		CloseHandle(fileMapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	mapping.file    = file;
+	mapping.mapping = fileMapping;
+	mapping.size    = static_cast<size_t>(fileSize.QuadPart);
+#else
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat fileStat;
+	if (fstat(file, &fileStat) != 0 || static_cast<size_t>(fileStat.st_size) < sizeof(RegionHeader))
+	{
+		close(file);
+		return false;
+	}
+
+	void* data = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+
+	// The mapping keeps the file alive on its own
+	close(file);
+
+	if (data == MAP_FAILED)
+		return false;
+
+	mapping.size = static_cast<size_t>(fileStat.st_size);
+#endif
+
+	mapping.data = reinterpret_cast<const uint8_t*>(data);
+
+	const RegionHeader* header = reinterpret_cast<const RegionHeader*>(mapping.data);
+	if (memcmp(header->magic, REGION_MAGIC, sizeof(REGION_MAGIC)) != 0 || header->version != REGION_VERSION ||
+	    header->chunkBlockBitSize != CHUNK_BLOCK_BIT_SIZE)
+	{
+		UnmapRegion(mapping);
+		return false;
+	}
+
+	return true;
+}
+
+void phx::RegionStore::UnmapRegion(RegionMapping& mapping)
+{
+	if (mapping.data == nullptr)
+		return;
+
+#ifdef _WIN32
+	UnmapViewOfFile(mapping.data);
+	CloseHandle(mapping.mapping);
+	CloseHandle(mapping.file);
+	mapping.file    = nullptr;
+	mapping.mapping = nullptr;
+#else
+	munmap(const_cast<uint8_t*>(mapping.data), mapping.size);
+#endif
+
+	mapping.data = nullptr;
+	mapping.size = 0;
+}
+
+uint64_t phx::RegionStore::PackPosition(glm::ivec3 position)
+{
+	// 21 bits per axis is far beyond any world the engine can hold
+	const uint64_t mask = (1ull << 21) - 1;
+	return (static_cast<uint64_t>(position.x) & mask) | ((static_cast<uint64_t>(position.y) & mask) << 21) |
+	       ((static_cast<uint64_t>(position.z) & mask) << 42);
+}
+
+glm::ivec3 phx::RegionStore::UnpackPosition(uint64_t key)
+{
+	// Shift each axis to the top of the word and back down again to sign extend it
+	return glm::ivec3(static_cast<int64_t>(key << 43) >> 43, static_cast<int64_t>(key << 22) >> 43,
+	                  static_cast<int64_t>(key << 1) >> 43);
+}
+
+void phx::RegionStore::Compress(const ChunkBlock* blocks, std::vector<uint8_t>& record)
+{
+	// Palette of the distinct blocks in order of first use, chunks rarely hold more than a handful
+	std::vector<uint64_t>                  palette;
+	std::unordered_map<uint64_t, uint16_t> paletteLookup;
+
+	// Runs of one palette index, a run never crosses MAX_BLOCKS_PER_CHUNK so its length fits in 16 bits
+	std::vector<std::pair<uint16_t, uint16_t>> runs;
+
+	for (unsigned int i = 0; i < MAX_BLOCKS_PER_CHUNK; i++)
+	{
+		auto it = paletteLookup.find(blocks[i].id);
+		if (it == paletteLookup.end())
+		{
+			it = paletteLookup.emplace(blocks[i].id, static_cast<uint16_t>(palette.size())).first;
+			palette.push_back(blocks[i].id);
+		}
+
+		if (!runs.empty() && runs.back().second == it->second)
+			runs.back().first++;
+		else
+			runs.push_back({1, it->second});
+	}
+
+	Append(record, static_cast<uint16_t>(palette.size()));
+	for (uint64_t id : palette)
+	{
+		Append(record, id);
+	}
+
+	Append(record, static_cast<uint32_t>(runs.size()));
+	for (const std::pair<uint16_t, uint16_t>& run : runs)
+	{
+		Append(record, run.first);
+		Append(record, run.second);
+	}
+}
+
+bool phx::RegionStore::Decompress(const uint8_t* record, size_t size, ChunkBlock* blocks)
+{
+	const uint8_t* end = record + size;
+
+	uint16_t paletteSize = 0;
+	if (!Read(record, end, paletteSize) || static_cast<size_t>(end - record) < paletteSize * sizeof(uint64_t))
+		return false;
+
+	const uint8_t* palette = record;
+	record += paletteSize * sizeof(uint64_t);
+
+	uint32_t runCount = 0;
+	if (!Read(record, end, runCount))
+		return false;
+
+	unsigned int block = 0;
+	for (uint32_t i = 0; i < runCount; i++)
+	{
+		uint16_t length = 0;
+		uint16_t index  = 0;
+		if (!Read(record, end, length) || !Read(record, end, index))
+			return false;
+
+		if (index >= paletteSize || length > MAX_BLOCKS_PER_CHUNK - block)
+			return false;
+
+		uint64_t id;
+		memcpy(&id, palette + index * sizeof(uint64_t), sizeof(uint64_t));
+
+		for (uint16_t j = 0; j < length; j++)
+		{
+			blocks[block++] = ChunkBlock(id);
+		}
+	}
+
+	return block == MAX_BLOCKS_PER_CHUNK;
+}
@@ -0,0 +1,164 @@
+// BSD 3-Clause License
+// 
+// Copyright (c) 2022, Genten Studios
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <Globals/Globals.hpp>
+
+#include <Phoenix/Blocks.hpp>
+
+#include <condition_variable>
+#include <cstdint>
+#include <iosfwd>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace phx
+{
+	// Chunks are grouped per REGION_CHUNKS_PER_AXIS cube of chunks into one region file
+	const unsigned int REGION_CHUNK_BIT_SIZE      = 5;
+	const unsigned int REGION_CHUNK_BIT_SIZE_MASK = 0b11111;
+	const unsigned int REGION_CHUNKS_PER_AXIS     = 1 << REGION_CHUNK_BIT_SIZE;
+	const unsigned int REGION_CHUNK_COUNT         = REGION_CHUNKS_PER_AXIS * REGION_CHUNKS_PER_AXIS * REGION_CHUNKS_PER_AXIS;
+
+	// Persists chunk block data to region files.
+	//
+	// A region file starts with a table of where each of its chunks is stored, followed by the chunk records. Records are
+	// a palette of the distinct blocks in the chunk and runs of palette indices in LinearChunkLayout order. A rewritten
+	// chunk goes back where its last record was when it fits, otherwise it is appended and the old record is left behind
+	// as dead space. Once dead space makes up most of a region, the live records are copied into a fresh file.
+	//
+	// Saves are queued and written by a background thread. A chunk saved again before it was written replaces the queued
+	// copy, so only the latest one reaches the disk. Loads map the region file and only decode the requested record.
+	class RegionStore
+	{
+	public:
+		explicit RegionStore(std::string directory);
+
+		// Writes everything still queued before returning
+		~RegionStore();
+
+		RegionStore(const RegionStore&) = delete;
+		RegionStore& operator=(const RegionStore&) = delete;
+
+		// Copies the blocks, the caller is free to change them straight after
+		void SaveChunk(glm::ivec3 chunkPosition, const ChunkBlock* blocks);
+
+		// Fills MAX_BLOCKS_PER_CHUNK blocks, returns false and leaves them untouched if the chunk was never saved
+		bool LoadChunk(glm::ivec3 chunkPosition, ChunkBlock* blocks);
+
+		// Blocks until every queued save has been written
+		void Flush();
+
+		// Measured over every chunk saved or loaded so far, 0 until the first one
+		float GetSaveChunksPerSecond();
+		float GetLoadChunksPerSecond();
+
+	private:
+		struct RegionEntry
+		{
+			uint32_t offset; // 0 when the chunk is not stored
+			uint32_t size;
+		};
+
+		struct RegionHeader
+		{
+			char        magic[4];
+			uint32_t    version;
+			uint32_t    chunkBlockBitSize; // Records only load into chunks of the size they were saved from
+			RegionEntry entries[REGION_CHUNK_COUNT];
+		};
+
+		// Read only view of a whole region file, remapped after the file is written to
+		struct RegionMapping
+		{
+			const uint8_t* data = nullptr;
+			size_t         size = 0;
+#ifdef _WIN32
+			void* file    = nullptr;
+			void* mapping = nullptr;
+#endif
+		};
+
+		void WriterLoop();
+
+		using ChunkSave = std::pair<glm::ivec3, const std::vector<ChunkBlock>*>;
+
+		void WriteRegion(glm::ivec3 regionPosition, const std::vector<ChunkSave>& chunks);
+
+		// Copies the live records into a new file that replaces the region and updates the table to match. Leaves the
+		// file open on the region either way, returns false if it is still the old one.
+		static bool CompactRegion(const std::string& path, std::fstream& file, RegionHeader* header);
+
+		std::string GetRegionPath(glm::ivec3 regionPosition) const;
+
+		bool MapRegion(glm::ivec3 regionPosition, RegionMapping& mapping);
+
+		void UnmapRegion(RegionMapping& mapping);
+
+		static uint64_t PackPosition(glm::ivec3 position);
+
+		static glm::ivec3 UnpackPosition(uint64_t key);
+
+		static void Compress(const ChunkBlock* blocks, std::vector<uint8_t>& record);
+
+		static bool Decompress(const uint8_t* record, size_t size, ChunkBlock* blocks);
+
+		std::string mDirectory;
+
+		std::thread mWriter;
+
+		// Guards the queue and the counters
+		std::mutex              mMutex;
+		std::condition_variable mWorkAvailable;
+		std::condition_variable mWorkFinished;
+
+		// Keyed by packed chunk position, later saves replace earlier ones
+		std::map<uint64_t, std::vector<ChunkBlock>> mPendingSaves;
+
+		// The batch the writer is working on, loads read from it until it has reached the region files
+		std::map<uint64_t, std::vector<ChunkBlock>> mWritingSaves;
+
+		bool mStopping = false;
+
+		// Guards the region files and their mappings, held by the writer while it changes a file
+		std::mutex                        mFileMutex;
+		std::map<uint64_t, RegionMapping> mMappings;
+
+		uint64_t mChunksSaved      = 0;
+		uint64_t mSaveMicroseconds = 0;
+		uint64_t mChunksLoaded     = 0;
+		uint64_t mLoadMicroseconds = 0;
+	};
+} // namespace phx
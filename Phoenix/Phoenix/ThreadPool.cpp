@@ -0,0 +1,115 @@
+// BSD 3-Clause License
+// 
+// Copyright (c) 2022, Genten Studios
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <Phoenix/ThreadPool.hpp>
+
+#include <algorithm>
+
+phx::ThreadPool::ThreadPool(uint32_t threadCount)
+{
+	// hardware_concurrency may not be able to tell
+	mThreadCount = std::max(threadCount, 1u);
+
+	for (uint32_t i = 0; i < mThreadCount; ++i)
+	{
+		mThreads.emplace_back(&ThreadPool::WorkerLoop, this, i);
+	}
+}
+
+phx::ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStopping = true;
+	}
+	mWorkAvailable.notify_all();
+
+	for (std::thread& thread : mThreads)
+	{
+		thread.join();
+	}
+}
+
+uint32_t phx::ThreadPool::GetThreadCount() const { return mThreadCount; }
+
+void phx::ThreadPool::Dispatch(uint32_t taskCount, const Task& task)
+{
+	if (taskCount == 0)
+		return;
+
+	std::unique_lock<std::mutex> lock(mMutex);
+
+	mTask        = &task;
+	mTaskCount   = taskCount;
+	mBusyThreads = GetThreadCount();
+	++mGeneration;
+
+	mWorkAvailable.notify_all();
+	mWorkFinished.wait(lock, [this] { return mBusyThreads == 0; });
+
+	mTask = nullptr;
+}
+
+void phx::ThreadPool::WorkerLoop(uint32_t threadIndex)
+{
+	const uint32_t threadCount    = GetThreadCount();
+	uint64_t       seenGeneration = 0;
+
+	while (true)
+	{
+		const Task* task      = nullptr;
+		uint32_t    taskCount = 0;
+
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mWorkAvailable.wait(lock, [this, seenGeneration] { return mStopping || mGeneration != seenGeneration; });
+
+			if (mStopping)
+				return;
+
+			seenGeneration = mGeneration;
+			task           = mTask;
+			taskCount      = mTaskCount;
+		}
+
+		for (uint32_t i = threadIndex; i < taskCount; i += threadCount)
+		{
+			(*task)(i, threadIndex);
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (--mBusyThreads == 0)
+			{
+				mWorkFinished.notify_one();
+			}
+		}
+	}
+}
@@ -0,0 +1,76 @@
+// BSD 3-Clause License
+// 
+// Copyright (c) 2022, Genten Studios
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace phx
+{
+	// Fixed set of worker threads for splitting a batch of independent tasks. Tasks are handed out statically,
+	// task i always runs on worker i % GetThreadCount(), so tasks can use per worker state without locking.
+	class ThreadPool
+	{
+	public:
+		using Task = std::function<void(uint32_t taskIndex, uint32_t threadIndex)>;
+
+		explicit ThreadPool(uint32_t threadCount = std::thread::hardware_concurrency());
+
+		~ThreadPool();
+
+		uint32_t GetThreadCount() const;
+
+		// Runs the task for every index in [0, taskCount) and returns once all of them have finished.
+		// Not reentrant, only one thread may dispatch at a time.
+		void Dispatch(uint32_t taskCount, const Task& task);
+
+	private:
+		void WorkerLoop(uint32_t threadIndex);
+
+		// Set before any worker starts, the workers read it while mThreads is still being filled
+		uint32_t                 mThreadCount;
+		std::vector<std::thread> mThreads;
+
+		std::mutex              mMutex;
+		std::condition_variable mWorkAvailable;
+		std::condition_variable mWorkFinished;
+
+		const Task* mTask        = nullptr;
+		uint32_t    mTaskCount   = 0;
+		uint64_t    mGeneration  = 0;
+		uint32_t    mBusyThreads = 0;
+		bool        mStopping    = false;
+	};
+} // namespace phx
@@ -0,0 +1,139 @@
+// BSD 3-Clause License
+// 
+// Copyright (c) 2022, Genten Studios
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <Phoenix/VertexAllocator.hpp>
+
+#include <cassert>
+#include <iterator>
+
+phx::VertexAllocator::VertexAllocator(uint32_t size) : mSize(size) { InsertFreeRange(0, size); }
+
+uint32_t phx::VertexAllocator::Allocate(uint32_t size)
+{
+	if (size == 0)
+		return INVALID_OFFSET;
+
+	auto fit = mFreeBySize.lower_bound(size);
+
+	if (fit == mFreeBySize.end())
+		return INVALID_OFFSET;
+
+	const uint32_t offset    = fit->second;
+	const uint32_t rangeSize = fit->first;
+
+	EraseFreeRange(mFreeByOffset.find(offset));
+
+	// Whatever is left of the range stays free
+	if (rangeSize > size)
+		InsertFreeRange(offset + size, rangeSize - size);
+
+	mUsedSize += size;
+	mAllocationCount++;
+
+	return offset;
+}
+
+void phx::VertexAllocator::Free(uint32_t offset, uint32_t size)
+{
+	assert(offset + size <= mSize && "Freeing outside of the allocator");
+
+	mUsedSize -= size;
+	mAllocationCount--;
+
+	// Merge with the free ranges directly after and before
+	auto next = mFreeByOffset.lower_bound(offset);
+
+	if (next != mFreeByOffset.end() && next->first == offset + size)
+	{
+		size += next->second;
+
+		next = std::next(next);
+		EraseFreeRange(std::prev(next));
+	}
+
+	if (next != mFreeByOffset.begin())
+	{
+		auto previous = std::prev(next);
+
+		if (previous->first + previous->second == offset)
+		{
+			offset = previous->first;
+			size += previous->second;
+
+			EraseFreeRange(previous);
+		}
+	}
+
+	InsertFreeRange(offset, size);
+}
+
+phx::VertexAllocator::Statistics phx::VertexAllocator::GetStatistics() const
+{
+	Statistics statistics;
+	statistics.totalSize        = mSize;
+	statistics.usedSize         = mUsedSize;
+	statistics.allocationCount  = mAllocationCount;
+	statistics.freeRangeCount   = static_cast<uint32_t>(mFreeByOffset.size());
+	statistics.largestFreeRange = mFreeBySize.empty() ? 0 : mFreeBySize.rbegin()->first;
+
+	return statistics;
+}
+
+float phx::VertexAllocator::GetFragmentation() const
+{
+	const uint32_t freeSize = mSize - mUsedSize;
+
+	if (freeSize == 0)
+		return 0.0f;
+
+	return 1.0f - static_cast<float>(mFreeBySize.rbegin()->first) / static_cast<float>(freeSize);
+}
+
+void phx::VertexAllocator::InsertFreeRange(uint32_t offset, uint32_t size)
+{
+	mFreeByOffset.emplace(offset, size);
+	mFreeBySize.emplace(size, offset);
+}
+
+void phx::VertexAllocator::EraseFreeRange(std::map<uint32_t, uint32_t>::iterator range)
+{
+	auto sizes = mFreeBySize.equal_range(range->second);
+
+	for (auto it = sizes.first; it != sizes.second; ++it)
+	{
+		if (it->second == range->first)
+		{
+			mFreeBySize.erase(it);
+			break;
+		}
+	}
+
+	mFreeByOffset.erase(range);
+}
@@ -0,0 +1,80 @@
+// BSD 3-Clause License
+// 
+// Copyright (c) 2022, Genten Studios
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+namespace phx
+{
+	// Hands out variable sized ranges of a fixed pool. Free ranges are kept both by offset, so neighbours merge back
+	// together when freed, and by size, so the smallest range that fits is found without walking the whole list.
+	class VertexAllocator
+	{
+	public:
+		static const uint32_t INVALID_OFFSET = 0xFFFFFFFF;
+
+		struct Statistics
+		{
+			uint32_t totalSize;
+			uint32_t usedSize;
+			uint32_t allocationCount;
+			uint32_t freeRangeCount;
+			uint32_t largestFreeRange;
+		};
+
+		explicit VertexAllocator(uint32_t size);
+
+		// Returns INVALID_OFFSET when no free range is large enough
+		uint32_t Allocate(uint32_t size);
+
+		void Free(uint32_t offset, uint32_t size);
+
+		Statistics GetStatistics() const;
+
+		// Share of the free space outside of the largest free range, 0 when it is all one range. Anything larger than the
+		// largest free range fails even though there is enough space in total.
+		float GetFragmentation() const;
+
+	private:
+		void InsertFreeRange(uint32_t offset, uint32_t size);
+
+		void EraseFreeRange(std::map<uint32_t, uint32_t>::iterator range);
+
+		uint32_t mSize;
+		uint32_t mUsedSize        = 0;
+		uint32_t mAllocationCount = 0;
+
+		// Offset to size, and size to offset for best fit
+		std::map<uint32_t, uint32_t>      mFreeByOffset;
+		std::multimap<uint32_t, uint32_t> mFreeBySize;
+	};
+} // namespace phx
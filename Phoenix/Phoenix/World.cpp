@@ -30,9 +30,18 @@
 
 #include <Phoenix/World.hpp>
 
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <limits>
+
 #include <Phoenix/Chunk.hpp>
-#include <Phoenix/Collision.hpp>
+#include <Phoenix/DepthPyramid.hpp>
 #include <Phoenix/Mods.hpp>
+#include <Phoenix/RegionStore.hpp>
+#include <Phoenix/ThreadPool.hpp>
+#include <Phoenix/VertexAllocator.hpp>
+#include <Phoenix/WorldGenerator.hpp>
 #include <Renderer/Buffer.hpp>
 #include <Renderer/Device.hpp>
 #include <Renderer/DeviceMemory.hpp>
@@ -45,43 +54,112 @@
 #include <ResourceManager/ResourceManager.hpp>
 #include <ResourceManager/RenderTechnique.hpp>
 
+// How often edited chunks are handed to the region store
+static const int CHUNK_SAVE_INTERVAL_SECONDS = 5;
+
 phx::World::World(RenderDevice* device, MemoryHeap* memoryHeap, ResourceManager* resourceManager)
     : mDevice(device), mResourceManager(resourceManager)
 {
+	mCamera     = mResourceManager->GetResource<Camera>("Camera");
+	mThreadPool = mResourceManager->GetResource<ThreadPool>("ThreadPool");
+
 	mVertexBuffer = std::unique_ptr<Buffer>(
-	    new Buffer(mDevice, memoryHeap, VERTEX_PAGE_SIZE * sizeof(VertexData) * TOTAL_VERTEX_PAGE_COUNT,
+	    new Buffer(mDevice, memoryHeap, VERTEX_BUFFER_VERTEX_COUNT * sizeof(VertexData),
 	               VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
 	               VK_SHARING_MODE_EXCLUSIVE));
 
 	mIndirectDrawCommands = std::unique_ptr<Buffer>(
-	    new Buffer(mDevice, memoryHeap, sizeof(VkDrawIndirectCommand) * TOTAL_VERTEX_PAGE_COUNT, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	    new Buffer(mDevice, memoryHeap, sizeof(VkDrawIndexedIndirectCommand) * TOTAL_VERTEX_PAGE_COUNT, VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
 	               VK_SHARING_MODE_EXCLUSIVE));
 
-	mPositionBuffer = std::unique_ptr<Buffer>(
-	    new Buffer(mDevice, memoryHeap, sizeof(glm::mat4) * TOTAL_VERTEX_PAGE_COUNT, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	for (CullingOutput& cullingOutput : mCullingOutputs)
+	{
+		cullingOutput.drawCommands = std::unique_ptr<Buffer>(
+		    new Buffer(mDevice, memoryHeap, sizeof(VkDrawIndexedIndirectCommand) * TOTAL_VERTEX_PAGE_COUNT,
+		               VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		               VK_SHARING_MODE_EXCLUSIVE));
+
+		cullingOutput.drawCount = std::unique_ptr<Buffer>(
+		    new Buffer(mDevice, memoryHeap, sizeof(uint32_t),
+		               VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		               VK_SHARING_MODE_EXCLUSIVE));
+	}
+
+	mPageVisibility = std::unique_ptr<Buffer>(new Buffer(mDevice, memoryHeap, sizeof(uint32_t) * TOTAL_VERTEX_PAGE_COUNT,
+	                                                     VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	                                                     VK_SHARING_MODE_EXCLUSIVE));
+
+	// Lives in mappable memory so the debug UI can read it back
+	mCullingStatistics = std::unique_ptr<Buffer>(
+	    new Buffer(mDevice, memoryHeap, sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
 	               VK_SHARING_MODE_EXCLUSIVE));
 
-	mFreeMemoryPoolCount = TOTAL_VERTEX_PAGE_COUNT;
+	mPageRecordBuffer = std::unique_ptr<Buffer>(new Buffer(mDevice, memoryHeap, sizeof(PageRecord) * TOTAL_VERTEX_PAGE_COUNT,
+	                                                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	                                                       VK_SHARING_MODE_EXCLUSIVE));
+
+	mPageBoundsBuffer = std::unique_ptr<Buffer>(new Buffer(mDevice, memoryHeap, sizeof(PageBounds) * TOTAL_VERTEX_PAGE_COUNT,
+	                                                       VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	                                                       VK_SHARING_MODE_EXCLUSIVE));
+
+	mVertexAllocator = std::unique_ptr<VertexAllocator>(new VertexAllocator(VERTEX_BUFFER_VERTEX_COUNT));
+	mVertexBudget    = std::min(VERTEX_MEMORY_BUDGET, VERTEX_BUFFER_VERTEX_COUNT);
+
+	mChunkDistances = std::unique_ptr<float[]>(new float[MAX_CHUNKS]());
+
+	std::unique_ptr<uint32_t> quadIndices = std::unique_ptr<uint32_t>(new uint32_t[MAX_FACES_PER_PAGE * INDICES_PER_FACE]);
 
-	mIndirectBufferCPU = std::unique_ptr<VkDrawIndirectCommand>(new VkDrawIndirectCommand[TOTAL_VERTEX_PAGE_COUNT]);
+	const uint32_t QUAD_INDICES[INDICES_PER_FACE] = {0, 1, 2, 2, 3, 0};
 
-	VkDrawIndirectCommand indirectCommandInstance {};
-	indirectCommandInstance.vertexCount   = 0;
+	for (uint32_t face = 0; face < MAX_FACES_PER_PAGE; face++)
+	{
+		for (uint32_t i = 0; i < INDICES_PER_FACE; i++)
+		{
+			quadIndices.get()[face * INDICES_PER_FACE + i] = face * VERTICES_PER_FACE + QUAD_INDICES[i];
+		}
+	}
+
+	mQuadIndexBuffer = std::unique_ptr<Buffer>(new Buffer(mDevice, memoryHeap, sizeof(uint32_t) * MAX_FACES_PER_PAGE * INDICES_PER_FACE,
+	                                                      VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+	                                                      VK_SHARING_MODE_EXCLUSIVE));
+
+	mQuadIndexBuffer->TransferInstantly(quadIndices.get(), sizeof(uint32_t) * MAX_FACES_PER_PAGE * INDICES_PER_FACE);
+
+	mIndirectBufferCPU = std::unique_ptr<VkDrawIndexedIndirectCommand[]>(new VkDrawIndexedIndirectCommand[TOTAL_VERTEX_PAGE_COUNT]);
+
+	VkDrawIndexedIndirectCommand indirectCommandInstance {};
+	indirectCommandInstance.indexCount    = 0;
 	indirectCommandInstance.instanceCount = 0;
+	indirectCommandInstance.firstIndex    = 0;
+	indirectCommandInstance.vertexOffset  = 0;
 	indirectCommandInstance.firstInstance = 0;
-	indirectCommandInstance.firstVertex   = 0;
 
 	for (uint32_t i = 0; i < TOTAL_VERTEX_PAGE_COUNT; i++)
 	{
-		mIndirectBufferCPU.get()[i] = indirectCommandInstance;
+		// Each page reads its own position instance, where it draws from is only known once it is allocated
+		indirectCommandInstance.firstInstance = i;
+
+		mIndirectBufferCPU[i] = indirectCommandInstance;
 	}
 
-	mIndexedIndirectResourceTable =
-	    mResourceManager->GetResource<ResourceTableLayout>("IndexedIndirectCommandResourceTableLayout")->CreateTable();
-	mIndexedIndirectResourceTable->Bind(0, mIndirectDrawCommands.get());
+	for (CullingOutput& cullingOutput : mCullingOutputs)
+	{
+		cullingOutput.resourceTable =
+		    mResourceManager->GetResource<ResourceTableLayout>("IndexedIndirectCommandResourceTableLayout")->CreateTable();
+		cullingOutput.resourceTable->Bind(0, mIndirectDrawCommands.get());
+		cullingOutput.resourceTable->Bind(1, cullingOutput.drawCommands.get());
+		cullingOutput.resourceTable->Bind(2, cullingOutput.drawCount.get());
+		cullingOutput.resourceTable->Bind(3, mPageVisibility.get());
+		cullingOutput.resourceTable->Bind(4, mCullingStatistics.get());
+	}
+
+	// Nothing has been seen yet, so the first frame is drawn entirely by the late phase
+	std::vector<uint32_t> pageVisibilityCPU(TOTAL_VERTEX_PAGE_COUNT);
+	mPageVisibility->TransferInstantly(pageVisibilityCPU.data(), sizeof(uint32_t) * TOTAL_VERTEX_PAGE_COUNT);
 
 	mChunkPositionsResourceTable = mResourceManager->GetResource<ResourceTableLayout>("ChunkPositionResourceTableLayout")->CreateTable();
-	mChunkPositionsResourceTable->Bind(0, mPositionBuffer.get());
+	mChunkPositionsResourceTable->Bind(0, mPageRecordBuffer.get());
+	mChunkPositionsResourceTable->Bind(1, mPageBoundsBuffer.get());
 
 	UpdateAllIndirectDraws();
 
@@ -91,19 +169,22 @@ phx::World::World(RenderDevice* device, MemoryHeap* memoryHeap, ResourceManager*
 
 	mFreeVertexPages = nullptr;
 
-	mPositionBufferCPU = std::unique_ptr<glm::mat4>(new glm::mat4[TOTAL_VERTEX_PAGE_COUNT]);
-	mVertexPages = std::unique_ptr<VertexPage>(new VertexPage[TOTAL_VERTEX_PAGE_COUNT]);
+	mPageRecordsCPU = std::unique_ptr<PageRecord[]>(new PageRecord[TOTAL_VERTEX_PAGE_COUNT]);
+	mPageBoundsCPU  = std::unique_ptr<PageBounds[]>(new PageBounds[TOTAL_VERTEX_PAGE_COUNT]);
+	mVertexPages = std::unique_ptr<VertexPage[]>(new VertexPage[TOTAL_VERTEX_PAGE_COUNT]);
 
 	for (int i = TOTAL_VERTEX_PAGE_COUNT - 1; i >= 0; --i)
 	{
-		mPositionBufferCPU.get()[i] = glm::mat4(1.0f);
+		mPageRecordsCPU[i] = {glm::ivec3(0), 0};
+		mPageBoundsCPU[i]  = {glm::vec4(0.0f), glm::vec4(0.0f)};
 
-		mVertexPages.get()[i].index       = i;
-		mVertexPages.get()[i].offset      = (VERTEX_PAGE_SIZE * sizeof(VertexData)) * i;
-		mVertexPages.get()[i].vertexCount = 0;
-		mVertexPages.get()[i].next        = mFreeVertexPages;
+		mVertexPages[i].index       = i;
+		mVertexPages[i].offset      = 0;
+		mVertexPages[i].capacity    = 0;
+		mVertexPages[i].vertexCount = 0;
+		mVertexPages[i].next        = mFreeVertexPages;
 
-		mFreeVertexPages = &mVertexPages.get()[i];
+		mFreeVertexPages = &mVertexPages[i];
 	}
 	
 	for (int z = 0; z < MAX_WORLD_CHUNKS_PER_AXIS; ++z)
@@ -117,7 +198,6 @@ phx::World::World(RenderDevice* device, MemoryHeap* memoryHeap, ResourceManager*
 	
 				
 				mChunks[index].SetPosition(glm::ivec3(x, y, z));
-				mChunks[index].SetRenderPosition(glm::vec3(x, y, z));
 	
 				// On start up the chunks are already sorted
 				mChunksSorted[index] = &mChunks[index];
@@ -172,10 +252,10 @@ phx::World::World(RenderDevice* device, MemoryHeap* memoryHeap, ResourceManager*
 		}
 	}
 
-	ModHandler* modHandler = resourceManager->GetResource<ModHandler>("ModHandler");
+	mBlockStates = resourceManager->GetResource<BlockStateRegistry>("BlockStateRegistry");
 	for (int i = 0; i < MAX_CHUNKS; ++i)
 	{
-		mChunks[i].Initialize(this, mVertexBuffer.get(), modHandler);
+		mChunks[i].Initialize(this, mVertexBuffer.get(), mBlockStates);
 
 		int x = (MAX_WORLD_CHUNKS_PER_AXIS / 2);
 		int y = (MAX_WORLD_CHUNKS_PER_AXIS / 2);
@@ -190,56 +270,313 @@ phx::World::World(RenderDevice* device, MemoryHeap* memoryHeap, ResourceManager*
 		z *= CHUNK_BLOCK_SIZE;
 
 		mChunks[i].SetPosition(glm::ivec3(x, y, z));
-		mChunks[i].SetRenderPosition(glm::vec3(x, y, z));
 	}
 
+	// Index the chunks by where they ended up rather than by how they were laid out, so the lookup keeps working if the
+	// layout above changes. The world is a cube of chunks, so the grid holds exactly MAX_CHUNKS cells.
+	mChunkGridMin = glm::ivec3(std::numeric_limits<int>::max());
+	for (int i = 0; i < MAX_CHUNKS; ++i)
+	{
+		mChunkGridMin = glm::min(mChunkGridMin, mChunks[i].GetPosition() >> static_cast<int>(CHUNK_BLOCK_BIT_SIZE));
+	}
+
+	mChunkGrid = new Chunk*[MAX_CHUNKS]();
+	for (int i = 0; i < MAX_CHUNKS; ++i)
+	{
+		const glm::ivec3 cell = (mChunks[i].GetPosition() >> static_cast<int>(CHUNK_BLOCK_BIT_SIZE)) - mChunkGridMin;
+
+		assert(glm::all(glm::lessThan(cell, glm::ivec3(MAX_WORLD_CHUNKS_PER_AXIS))) && "Chunks do not fit in the chunk grid");
+
+		mChunkGrid[cell.x + (cell.y * MAX_WORLD_CHUNKS_PER_AXIS) + (cell.z * MAX_WORLD_CHUNKS_PER_AXIS * MAX_WORLD_CHUNKS_PER_AXIS)] =
+		    &mChunks[i];
+	}
+
+	mRegionStore  = std::unique_ptr<RegionStore>(new RegionStore("saves/world"));
+	mGenerator    = std::unique_ptr<WorldGenerator>(new TerrainGenerator(1337));
+	mBlockScratch = std::unique_ptr<ChunkBlock[]>(new ChunkBlock[MAX_BLOCKS_PER_CHUNK]);
+
+	// Saved chunks take the place of generated ones
 	for (int i = 0; i < MAX_CHUNKS; ++i)
 	{
-		mChunks[i].GenerateWorld();
+		const glm::ivec3 chunkPosition = mChunks[i].GetPosition() >> static_cast<int>(CHUNK_BLOCK_BIT_SIZE);
+
+		if (mRegionStore->LoadChunk(chunkPosition, mBlockScratch.get()))
+		{
+			mChunks[i].WriteBlocks(mBlockScratch.get());
+			mChunks[i].MarkDirty();
+		}
+		else
+			mChunks[i].GenerateWorld(mGenerator.get());
 	}
 
-	UpdateAllPositionBuffers();
+	UpdateAllPageRecords();
 }
 
 phx::World::~World()
 {
+	// Destroying the store writes out everything still queued
+	SaveModifiedChunks();
+	mRegionStore.reset();
+
 	mVertexBuffer.reset();
 
 	delete[] mChunks;
 	delete[] mChunksSorted;
+	delete[] mChunkGrid;
 }
 
 void phx::World::Update()
 {
+	// Saving only copies the blocks, the region store writes them out in the background. A chunk being edited would
+	// otherwise be copied and rewritten every frame, the destructor saves whatever is left.
+	const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+	if (now - mLastSaveTime >= std::chrono::seconds(CHUNK_SAVE_INTERVAL_SECONDS))
+	{
+		SaveModifiedChunks();
+		mLastSaveTime = now;
+	}
+
+	UpdateChunkLODs();
+
+	mFarthestResidentDistance = 0.0f;
+
+	for (int i = 0; i < MAX_CHUNKS; ++i)
+	{
+		if (mChunks[i].HasMesh())
+			mFarthestResidentDistance = std::max(mFarthestResidentDistance, mChunkDistances[i]);
+	}
+
+	for (int i = 0; i < MAX_CHUNKS; ++i)
+	{
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+		if (mChunks[i].Update())
+		{
+			mChunksMeshed++;
+			mMeshMicroseconds +=
+			    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+		}
+	}
+}
+
+void phx::World::UpdateChunkLODs()
+{
+	// Distance at which chunks move to each coarser level, level n is used past LOD_DISTANCES[n - 1]
+	const float LOD_DISTANCES[MAX_CHUNK_LOD] = {64.0f, 128.0f, 256.0f};
+
+	// Chunks have to move this far past a threshold before switching, so one sitting on it does not keep remeshing
+	const float LOD_HYSTERESIS = 8.0f;
+
+	const glm::vec3 cameraPosition = mCamera->GetPosition();
+
+	for (int i = 0; i < MAX_CHUNKS; ++i)
+	{
+		// Distance to the nearest point of the chunk, so a chunk the camera is in is always at full detail
+		const glm::vec3 chunkMin = glm::vec3(mChunks[i].GetPosition());
+		const glm::vec3 chunkMax = chunkMin + glm::vec3(CHUNK_BLOCK_SIZE);
+		const float     distance = glm::distance(cameraPosition, glm::clamp(cameraPosition, chunkMin, chunkMax));
+
+		mChunkDistances[i] = distance;
+
+		uint32_t lod = mChunks[i].GetLOD();
+
+		while (lod < MAX_CHUNK_LOD && distance > LOD_DISTANCES[lod] + LOD_HYSTERESIS)
+			lod++;
+
+		while (lod > 0 && distance < LOD_DISTANCES[lod - 1] - LOD_HYSTERESIS)
+			lod--;
+
+		mChunks[i].SetLOD(lod);
+	}
+}
+
+void phx::World::SaveModifiedChunks()
+{
+	for (int i = 0; i < MAX_CHUNKS; ++i)
+	{
+		if (!mChunks[i].IsModified())
+			continue;
+
+		mChunks[i].ReadBlocks(mBlockScratch.get());
+		mRegionStore->SaveChunk(mChunks[i].GetPosition() >> static_cast<int>(CHUNK_BLOCK_BIT_SIZE), mBlockScratch.get());
+		mChunks[i].ClearModified();
+	}
+}
+
+void phx::World::BenchmarkRegionStore()
+{
+	for (int i = 0; i < MAX_CHUNKS; ++i)
+	{
+		mChunks[i].ReadBlocks(mBlockScratch.get());
+		mRegionStore->SaveChunk(mChunks[i].GetPosition() >> static_cast<int>(CHUNK_BLOCK_BIT_SIZE), mBlockScratch.get());
+		mChunks[i].ClearModified();
+	}
+
+	// Loads would otherwise be served from the save queue rather than the region files
+	mRegionStore->Flush();
+
+	std::unique_ptr<ChunkBlock[]> scratch = std::unique_ptr<ChunkBlock[]>(new ChunkBlock[MAX_BLOCKS_PER_CHUNK]);
+
+	for (int i = 0; i < MAX_CHUNKS; ++i)
+	{
+		mRegionStore->LoadChunk(mChunks[i].GetPosition() >> static_cast<int>(CHUNK_BLOCK_BIT_SIZE), scratch.get());
+	}
+}
+
+phx::RegionStore* phx::World::GetRegionStore() { return mRegionStore.get(); }
+
+// Counts the faces between solid blocks and air inside one chunk, the chunk border counts as air
+template <typename Layout>
+static uint32_t CountExposedFaces(const phx::ChunkBlock* blocks)
+{
+	uint32_t exposedFaces = 0;
+
+	for (uint32_t i = 0; i < MAX_BLOCKS_PER_CHUNK; i++)
+	{
+		if (blocks[i] == phx::ModHandler::GetAirBlock())
+			continue;
+
+		const glm::ivec3 position = Layout::Position(i);
+
+		for (const int(&offset)[3] : phx::ChunkSize::FACE_OFFSETS)
+		{
+			const glm::ivec3 neighbour = position + glm::ivec3(offset[0], offset[1], offset[2]);
+
+			if (glm::any(glm::lessThan(neighbour, glm::ivec3(0))) ||
+			    glm::any(glm::greaterThanEqual(neighbour, glm::ivec3(CHUNK_BLOCK_SIZE))) ||
+			    blocks[Layout::Index(neighbour.x, neighbour.y, neighbour.z)] == phx::ModHandler::GetAirBlock())
+			{
+				exposedFaces++;
+			}
+		}
+	}
+
+	return exposedFaces;
+}
+
+template <typename Layout>
+static float TimeExposedFaceSweep(const std::vector<phx::ChunkBlock>& blocks, uint32_t& exposedFaces)
+{
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	exposedFaces = 0;
+
+	for (size_t chunk = 0; chunk < blocks.size(); chunk += MAX_BLOCKS_PER_CHUNK)
+	{
+		exposedFaces += CountExposedFaces<Layout>(&blocks[chunk]);
+	}
+
+	return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void phx::World::BenchmarkChunkLayouts()
+{
+	std::vector<ChunkBlock> linearBlocks(static_cast<size_t>(MAX_CHUNKS) * MAX_BLOCKS_PER_CHUNK);
+	std::vector<ChunkBlock> mortonBlocks(linearBlocks.size());
 
 	for (int i = 0; i < MAX_CHUNKS; ++i)
 	{
-		mChunks[i].Update();
+		ChunkBlock* linear = &linearBlocks[static_cast<size_t>(i) * MAX_BLOCKS_PER_CHUNK];
+		ChunkBlock* morton = &mortonBlocks[static_cast<size_t>(i) * MAX_BLOCKS_PER_CHUNK];
+
+		mChunks[i].ReadBlocks(linear);
+
+		for (uint32_t index = 0; index < MAX_BLOCKS_PER_CHUNK; index++)
+		{
+			const glm::ivec3 position = LinearChunkLayout::Position(index);
+			morton[MortonChunkLayout::Index(position.x, position.y, position.z)] = linear[index];
+		}
 	}
+
+	uint32_t linearFaces = 0;
+	uint32_t mortonFaces = 0;
+
+	mLinearLayoutMilliseconds = TimeExposedFaceSweep<LinearChunkLayout>(linearBlocks, linearFaces);
+	mMortonLayoutMilliseconds = TimeExposedFaceSweep<MortonChunkLayout>(mortonBlocks, mortonFaces);
+
+	assert(linearFaces == mortonFaces && "Both layouts hold the same blocks");
+}
+
+float phx::World::GetLinearLayoutMilliseconds() const { return mLinearLayoutMilliseconds; }
+
+float phx::World::GetMortonLayoutMilliseconds() const { return mMortonLayoutMilliseconds; }
+
+float phx::World::GetAverageMeshMilliseconds() const
+{
+	if (mChunksMeshed == 0)
+		return 0.0f;
+
+	return static_cast<float>(mMeshMicroseconds) / static_cast<float>(mChunksMeshed) / 1000.0f;
 }
 
-void phx::World::ComputeVisibility(VkCommandBuffer* commandBuffer, uint32_t index)
+phx::WorldGenerator* phx::World::GetGenerator() { return mGenerator.get(); }
+
+void phx::World::ComputeVisibility(VkCommandBuffer* commandBuffer, uint32_t index, CullingPhase phase)
 {
+	CullingOutput& cullingOutput = mCullingOutputs[phase];
 
-	RenderTechnique* frustrumPipeline    = mResourceManager->GetResource<RenderTechnique>("ViewFrustrumCulling");
-	ResourceTable*   cameraResourceTable = mResourceManager->GetResource<ResourceTable>("CameraResourceTable");
+	RenderTechnique* cullingPipeline =
+	    mResourceManager->GetResource<RenderTechnique>(phase == Early ? "ViewFrustrumCulling" : "OcclusionCulling");
+	ResourceTable* cameraResourceTable = mResourceManager->GetResource<ResourceTable>("CameraResourceTable");
 
-	frustrumPipeline->GetPipeline()->Use(commandBuffer, index);
+	cullingPipeline->GetPipeline()->Use(commandBuffer, index);
 
-	cameraResourceTable->Use(commandBuffer, index, 0, frustrumPipeline->GetPipelineLayout()->GetPipelineLayout(),
+	cameraResourceTable->Use(commandBuffer, index, 0, cullingPipeline->GetPipelineLayout()->GetPipelineLayout(),
 	                         VK_PIPELINE_BIND_POINT_COMPUTE);
 
-	mChunkPositionsResourceTable->Use(commandBuffer, index, 1, frustrumPipeline->GetPipelineLayout()->GetPipelineLayout(),
+	mChunkPositionsResourceTable->Use(commandBuffer, index, 1, cullingPipeline->GetPipelineLayout()->GetPipelineLayout(),
 	                                  VK_PIPELINE_BIND_POINT_COMPUTE);
 
-	mIndexedIndirectResourceTable->Use(commandBuffer, index, 2, frustrumPipeline->GetPipelineLayout()->GetPipelineLayout(),
-	                                   VK_PIPELINE_BIND_POINT_COMPUTE);
+	cullingOutput.resourceTable->Use(commandBuffer, index, 2, cullingPipeline->GetPipelineLayout()->GetPipelineLayout(),
+	                                 VK_PIPELINE_BIND_POINT_COMPUTE);
 
-	vkCmdDispatch(commandBuffer[index], TOTAL_VERTEX_PAGE_COUNT, 1, 1);
+	if (phase == Late)
+	{
+		mResourceManager->GetResource<DepthPyramid>("DepthPyramid")
+		    ->GetResourceTable()
+		    ->Use(commandBuffer, index, 3, cullingPipeline->GetPipelineLayout()->GetPipelineLayout(), VK_PIPELINE_BIND_POINT_COMPUTE);
+	}
+
+	// The culling pass appends to the visible list, so the counter has to start from zero every frame. Without
+	// draw indirect count support every slot is drawn, so the unused tail must not contain stale draws either.
+	vkCmdFillBuffer(commandBuffer[index], cullingOutput.drawCount->GetBuffer(), 0, sizeof(uint32_t), 0);
+	if (!mDevice->SupportsDrawIndirectCount())
+	{
+		vkCmdFillBuffer(commandBuffer[index], cullingOutput.drawCommands->GetBuffer(), 0, VK_WHOLE_SIZE, 0);
+	}
+
+	if (phase == Early)
+	{
+		vkCmdFillBuffer(commandBuffer[index], mCullingStatistics->GetBuffer(), 0, sizeof(uint32_t), 0);
+	}
+
+	// Also orders this frame's early phase after the page visibility written by the last late phase
+	VkMemoryBarrier clearBarrier = {};
+	clearBarrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	clearBarrier.srcAccessMask   = VK_ACCESS_TRANSFER_WRITE_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	clearBarrier.dstAccessMask   = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer[index], VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+	                     VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &clearBarrier, 0, nullptr, 0, nullptr);
+
+	vkCmdDispatch(commandBuffer[index], (TOTAL_VERTEX_PAGE_COUNT + CULLING_WORKGROUP_SIZE - 1) / CULLING_WORKGROUP_SIZE, 1, 1);
+
+	// Make the compacted draws visible to the indirect draw in the world pass, and the statistics to the debug UI
+	VkMemoryBarrier cullingBarrier = {};
+	cullingBarrier.sType           = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	cullingBarrier.srcAccessMask   = VK_ACCESS_SHADER_WRITE_BIT;
+	cullingBarrier.dstAccessMask   = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_HOST_READ_BIT;
+
+	vkCmdPipelineBarrier(commandBuffer[index], VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+	                     VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &cullingBarrier, 0, nullptr, 0,
+	                     nullptr);
 }
 
-void phx::World::Draw(VkCommandBuffer* commandBuffer, uint32_t index)
+void phx::World::Draw(VkCommandBuffer* commandBuffer, uint32_t index, CullingPhase phase)
 {
+	CullingOutput& cullingOutput = mCullingOutputs[phase];
+
 	RenderTechnique* standardMaterial = mResourceManager->GetResource<RenderTechnique>("StandardMaterial");
 
 	standardMaterial->GetPipeline()->Use(commandBuffer, index);
@@ -247,22 +584,30 @@ void phx::World::Draw(VkCommandBuffer* commandBuffer, uint32_t index)
 	// todo find a way of auto binding global data for shaders, perhaps a global and local mapping
 	mResourceManager->GetResource<ResourceTable>("CameraResourceTable")
 		->Use(commandBuffer, index, 0, standardMaterial->GetPipelineLayout()->GetPipelineLayout());
+	mChunkPositionsResourceTable->Use(commandBuffer, index, 1, standardMaterial->GetPipelineLayout()->GetPipelineLayout());
 	mResourceManager->GetResource<ResourceTable>("SamplerArrayResourceTable")
-		->Use(commandBuffer, index, 1, standardMaterial->GetPipelineLayout()->GetPipelineLayout());
+		->Use(commandBuffer, index, 2, standardMaterial->GetPipelineLayout()->GetPipelineLayout());
 
-	for (int i = 0; i < TOTAL_VERTEX_PAGE_COUNT; i++)
-	{
-		VkDeviceSize offsets[] = { sizeof(VertexData) * VERTEX_PAGE_SIZE * i };
+	// Pages address their own vertices and page record through vertexOffset and firstInstance, so the buffers are bound once
+	VkDeviceSize offsets[] = {0};
+	vkCmdBindVertexBuffers(commandBuffer[index], 0, 1, &mVertexBuffer->GetBuffer(), offsets);
+	vkCmdBindIndexBuffer(commandBuffer[index], mQuadIndexBuffer->GetBuffer(), 0, VK_INDEX_TYPE_UINT32);
 
-		vkCmdBindVertexBuffers(commandBuffer[index], 0, 1, &mVertexBuffer->GetBuffer(), offsets);
-
-		VkDeviceSize positionOffsets[] = { sizeof(glm::mat4) * i };
-		// Position data
-		vkCmdBindVertexBuffers(commandBuffer[index], 1, 1, &mPositionBuffer->GetBuffer(), positionOffsets);
-		vkCmdDrawIndirect(commandBuffer[index], mIndirectDrawCommands->GetBuffer(), sizeof(VkDrawIndirectCommand) * i, 1,
-			sizeof(VkDrawIndirectCommand));
+	if (mDevice->SupportsDrawIndirectCount())
+	{
+		vkCmdDrawIndexedIndirectCountKHR(commandBuffer[index], cullingOutput.drawCommands->GetBuffer(), 0,
+		                                 cullingOutput.drawCount->GetBuffer(), 0, TOTAL_VERTEX_PAGE_COUNT,
+		                                 sizeof(VkDrawIndexedIndirectCommand));
 	}
+	else
+	{
+		vkCmdDrawIndexedIndirect(commandBuffer[index], cullingOutput.drawCommands->GetBuffer(), 0, TOTAL_VERTEX_PAGE_COUNT,
+		                         sizeof(VkDrawIndexedIndirectCommand));
+	}
+}
 
+void phx::World::DrawSkybox(VkCommandBuffer* commandBuffer, uint32_t index)
+{
 	RenderTechnique* skybox = mResourceManager->GetResource<RenderTechnique>("Skybox");
 
 	skybox->GetPipeline()->Use(commandBuffer, index);
@@ -276,284 +621,523 @@ void phx::World::Draw(VkCommandBuffer* commandBuffer, uint32_t index)
 	vkCmdDraw(commandBuffer[index], 6, 1, 0, 0);
 }
 
-phx::VertexPage* phx::World::GetFreeVertexPage()
+phx::VertexPage* phx::World::AllocateVertexPage(uint32_t vertexCount, Chunk* owner)
 {
 	VertexPage* next = mFreeVertexPages;
-	if (mFreeVertexPages)
+	if (next == nullptr)
+		return nullptr;
+
+	const uint32_t capacity =
+	    (vertexCount + VERTEX_ALLOCATION_GRANULARITY - 1) / VERTEX_ALLOCATION_GRANULARITY * VERTEX_ALLOCATION_GRANULARITY;
+
+	// Only ever evicting farther chunks means a far chunk can never push out a near one, so the two cannot take turns
+	// evicting each other
+	const float ownerDistance = GetChunkDistance(owner);
+
+	uint32_t offset = VertexAllocator::INVALID_OFFSET;
+
+	while (true)
 	{
-		mFreeVertexPages = mFreeVertexPages->next;
-		next->next = nullptr;
-		next->vertexCount = 0;
+		if (mVertexAllocator->GetStatistics().usedSize + capacity <= mVertexBudget)
+			offset = mVertexAllocator->Allocate(capacity);
+
+		if (offset != VertexAllocator::INVALID_OFFSET)
+			break;
 
-		mFreeMemoryPoolCount--;
+		if (!EvictFarthestMesh(ownerDistance))
+			return nullptr;
 	}
+
+	mFreeVertexPages = mFreeVertexPages->next;
+	next->next        = nullptr;
+	next->offset      = offset;
+	next->capacity    = capacity;
+	next->vertexCount = 0;
+	next->boundsMin   = glm::vec3(CHUNK_BLOCK_SIZE);
+	next->boundsMax   = glm::vec3(0.0f);
+	next->direction   = 0;
+	next->lod         = 0;
+
 	return next;
 }
 
-unsigned int phx::World::GetFreeMemoryPoolCount() { return mFreeMemoryPoolCount; }
+const phx::VertexAllocator* phx::World::GetVertexAllocator() const { return mVertexAllocator.get(); }
 
-void phx::World::DestroyBlockFromView()
+bool phx::World::CanAdmitMesh(Chunk* chunk, uint32_t vertexCount) const
 {
-	const float		   placeRange = 6.0f;
-	const unsigned int stepCount = 20;
-	const float        stepSize = placeRange / stepCount;
+	const VertexAllocator::Statistics statistics = mVertexAllocator->GetStatistics();
+
+	if (statistics.usedSize + vertexCount <= mVertexBudget && statistics.largestFreeRange >= vertexCount)
+		return true;
+
+	return GetChunkDistance(chunk) < mFarthestResidentDistance;
+}
+
+void phx::World::SetVertexBudget(uint32_t vertexCount) { mVertexBudget = std::min(vertexCount, VERTEX_BUFFER_VERTEX_COUNT); }
+
+uint32_t phx::World::GetVertexBudget() const { return mVertexBudget; }
 
-	Chunk* chunk;
-	int localX;
-	int localY;
-	int localZ;
-	RaycastToBlock(stepSize, stepCount, chunk, localX, localY, localZ, RaycastMode::Destroy);
+uint64_t phx::World::GetEvictionCount() const { return mEvictionCount; }
+
+uint32_t phx::World::GetEvictedChunkCount() const
+{
+	uint32_t evictedChunkCount = 0;
 
-	if (chunk)
+	for (int i = 0; i < MAX_CHUNKS; ++i)
 	{
-		chunk->SetBlock(localX, localY, localZ, 0);
+		if (mChunks[i].IsEvicted())
+			evictedChunkCount++;
+	}
 
-		chunk->MarkDirty();
+	return evictedChunkCount;
+}
 
-		phx::ChunkNeighbours* nabours = chunk->GetNabours();
+bool phx::World::EvictFarthestMesh(float minDistance)
+{
+	Chunk* victim         = nullptr;
+	float  victimDistance = minDistance;
 
-		for (int j = 0; j < 6; j++)
+	for (int i = 0; i < MAX_CHUNKS; ++i)
+	{
+		if (mChunks[i].HasMesh() && mChunkDistances[i] > victimDistance)
 		{
-			if (nabours->neighbouringChunks[j] == nullptr)
-				continue;
-
-			(*nabours->neighbouringChunks[j])->MarkDirty();
+			victim         = &mChunks[i];
+			victimDistance = mChunkDistances[i];
 		}
 	}
+
+	if (victim == nullptr)
+		return false;
+
+	victim->EvictMesh();
+	mEvictionCount++;
+
+	return true;
+}
+
+float phx::World::GetChunkDistance(const Chunk* chunk) const { return mChunkDistances[chunk - mChunks]; }
+
+void phx::World::DefragmentVertexMemory()
+{
+	// Freed in one go, otherwise each remesh could only reuse the range its own chunk just gave back
+	for (int i = 0; i < MAX_CHUNKS; ++i)
+	{
+		mChunks[i].ReleaseMesh();
+	}
+}
+
+unsigned int phx::World::GetOccludedPageCount()
+{
+	void* memoryPtr = nullptr;
+	mCullingStatistics->GetDeviceMemory()->Map(sizeof(uint32_t), mCullingStatistics->GetMemoryOffset(), memoryPtr);
+	const uint32_t occludedPageCount = *reinterpret_cast<uint32_t*>(memoryPtr);
+	mCullingStatistics->GetDeviceMemory()->Unmap();
+
+	return occludedPageCount;
+}
+
+void phx::World::DestroyBlockFromView()
+{
+	const float placeRange = 6.0f;
+
+	RaycastHit hit = Raycast(mCamera->GetPosition(), mCamera->GetDirection(), placeRange);
+
+	if (hit.hit)
+	{
+		SetBlockWorld(hit.block, ModHandler::GetAirBlock());
+	}
 }
 
 void phx::World::PlaceBlockFromView()
 {
-	constexpr ChunkBlock stone = {0x00010001};
+	const ChunkBlock stone = mResourceManager->GetResource<ModHandler>("ModHandler")->GetChunkBlock("standard_blocks.stone");
 
-	const float        placeRange = 6.0f;
-	const unsigned int stepCount  = 20;
-	const float        stepSize   = placeRange / stepCount;
+	const float placeRange = 6.0f;
 
-	Chunk* chunk;
-	int    localX;
-	int    localY;
-	int    localZ;
-	RaycastToBlock(stepSize, stepCount, chunk, localX, localY, localZ, RaycastMode::Place);
+	RaycastHit hit = Raycast(mCamera->GetPosition(), mCamera->GetDirection(), placeRange);
 
-	if (chunk)
+	// Never place into the block the ray started in, it is either solid already or the one the camera is standing in
+	if (hit.hit && hit.previous != hit.block)
 	{
-		chunk->SetBlock(localX, localY, localZ, stone);
+		SetBlockWorld(hit.previous, stone);
+	}
+}
 
-		chunk->MarkDirty();
+phx::RaycastHit phx::World::Raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance) const
+{
+	// Amanatides and Woo, "A Fast Voxel Traversal Algorithm for Ray Tracing". Rather than sampling along the ray, step
+	// straight to whichever block boundary the ray crosses next, so no block is skipped however the ray is angled.
+
+	RaycastHit result = {};
+	result.hit        = false;
+
+	if (glm::dot(direction, direction) == 0.0f)
+		return result;
+
+	direction = glm::normalize(direction);
+
+	glm::ivec3 block = glm::ivec3(glm::floor(origin));
+	glm::ivec3 step;
 
-		phx::ChunkNeighbours* nabours = chunk->GetNabours();
+	// Distance along the ray to the next boundary on each axis, and between two boundaries on each axis
+	glm::vec3 nextBoundary;
+	glm::vec3 boundarySpacing;
 
-		for (int j = 0; j < 6; j++)
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		if (direction[axis] > 0.0f)
+		{
+			step[axis]            = 1;
+			nextBoundary[axis]    = (static_cast<float>(block[axis]) + 1.0f - origin[axis]) / direction[axis];
+			boundarySpacing[axis] = 1.0f / direction[axis];
+		}
+		else if (direction[axis] < 0.0f)
+		{
+			step[axis]            = -1;
+			nextBoundary[axis]    = (origin[axis] - static_cast<float>(block[axis])) / -direction[axis];
+			boundarySpacing[axis] = -1.0f / direction[axis];
+		}
+		else
 		{
-			if (nabours->neighbouringChunks[j] == nullptr)
-				continue;
+			step[axis]            = 0;
+			nextBoundary[axis]    = std::numeric_limits<float>::infinity();
+			boundarySpacing[axis] = std::numeric_limits<float>::infinity();
+		}
+	}
+
+	glm::ivec3 previous = block;
+	float      distance = 0.0f;
 
-			(*nabours->neighbouringChunks[j])->MarkDirty();
+	const ChunkBlock air = ModHandler::GetAirBlock();
+
+	while (distance <= maxDistance)
+	{
+		// Blocks outside of the world read as air, the ray may still enter the world further along
+		if (GetBlockWorld(block) != air)
+		{
+			result.hit      = true;
+			result.block    = block;
+			result.previous = previous;
+			result.distance = distance;
+			return result;
 		}
+
+		int axis = 0;
+		if (nextBoundary.y < nextBoundary[axis])
+			axis = 1;
+		if (nextBoundary.z < nextBoundary[axis])
+			axis = 2;
+
+		previous = block;
+		distance = nextBoundary[axis];
+
+		block[axis] += step[axis];
+		nextBoundary[axis] += boundarySpacing[axis];
 	}
 
+	return result;
 }
 
-void phx::World::RaycastToBlock(float step, int iteration, Chunk*& chunkReturn, int& localX, int& localY, int& localZ, RaycastMode mode)
+std::vector<phx::RaycastHit> phx::World::RaycastMany(const std::vector<glm::vec3>& origins,
+                                                     const std::vector<glm::vec3>& directions, float maxDistance) const
 {
-	chunkReturn            = nullptr; 
-	localX                 = 0;
-	localX                 = 0;
+	assert(origins.size() == directions.size() && "Every ray needs both an origin and a direction");
 
-	Camera*   camera       = mResourceManager->GetResource<Camera>("Camera");
-	glm::vec3 viewPosition = camera->GetPosition();
+	std::vector<RaycastHit> hits(origins.size());
 
-	// Todo in the future we know we will only ever be around the middle chunk, so no need to loop through them all
+	// Rays are cheap, so hand them out in batches to keep the dispatch overhead down
+	const uint32_t rayCount   = static_cast<uint32_t>(origins.size());
+	const uint32_t batchSize  = 64;
+	const uint32_t batchCount = (rayCount + batchSize - 1) / batchSize;
 
-	Chunk* chunk = nullptr;
+	if (batchCount == 0)
+		return hits;
 
-	// Find the starting chunk
-	for (int i = 0; i < MAX_CHUNKS; i++)
-	{
-		Chunk* next = &mChunks[i];
+	// Only reads the chunks, so the rays can run side by side as long as nothing edits the world meanwhile
+	mThreadPool->Dispatch(batchCount, [&](uint32_t batch, uint32_t) {
+		const uint32_t end = std::min(rayCount, (batch + 1) * batchSize);
 
-		if (PointToCube(viewPosition, next->GetPosition(), CHUNK_BLOCK_SIZE))
+		for (uint32_t i = batch * batchSize; i < end; ++i)
 		{
-			chunk = next;
-			break;
+			hits[i] = Raycast(origins[i], directions[i], maxDistance);
 		}
-	}
+	});
+
+	return hits;
+}
+
+phx::Chunk* phx::World::GetChunkAt(glm::ivec3 chunkPosition) const
+{
+	const glm::ivec3 cell = chunkPosition - mChunkGridMin;
 
-	// Check we found a chunk we are starting in
-	if (chunk != nullptr)
+	for (int axis = 0; axis < 3; ++axis)
 	{
-		glm::ivec3 lastPos = viewPosition;
+		if (cell[axis] < 0 || cell[axis] >= MAX_WORLD_CHUNKS_PER_AXIS)
+			return nullptr;
+	}
 
-		int lastLocalX = 0;
-		int lastLocalY = 0;
-		int lastLocalZ = 0;
-		Chunk* lastChunk = nullptr;
+	return mChunkGrid[cell.x + (cell.y * MAX_WORLD_CHUNKS_PER_AXIS) + (cell.z * MAX_WORLD_CHUNKS_PER_AXIS * MAX_WORLD_CHUNKS_PER_AXIS)];
+}
 
-		float currentStep = step;
-		unsigned int stepHalfCount = 0;
+phx::ChunkBlock phx::World::GetBlockWorld(glm::ivec3 blockPosition) const
+{
+	// The arithmetic shift floors, so negative positions land in the chunk below rather than rounding towards zero.
+	// Masking the two's complement value gives the matching local position in that chunk.
+	Chunk* chunk = GetChunkAt(blockPosition >> static_cast<int>(CHUNK_BLOCK_BIT_SIZE));
 
-		for (int i = 0; i < iteration; i++)
-		{
-			viewPosition += camera->GetDirection() * currentStep;
-			glm::ivec3 newPos = viewPosition;
+	if (chunk == nullptr)
+		return ModHandler::GetAirBlock();
 
-			if (viewPosition.x < 0)
-				newPos.x -= 1;
-			if (viewPosition.y < 0)
-				newPos.y -= 1;
-			if (viewPosition.z < 0)
-				newPos.z -= 1;
+	return chunk->GetBlock(blockPosition.x & CHUNK_BLOCK_BIT_SIZE_MASK, blockPosition.y & CHUNK_BLOCK_BIT_SIZE_MASK,
+	                       blockPosition.z & CHUNK_BLOCK_BIT_SIZE_MASK);
+}
 
-			if (newPos != lastPos)
+bool phx::World::SetBlockWorld(glm::ivec3 blockPosition, ChunkBlock block)
+{
+	if (GetChunkAt(blockPosition >> static_cast<int>(CHUNK_BLOCK_BIT_SIZE)) == nullptr)
+		return false;
+
+	EditBlock(blockPosition, mBlockStates->GetState(block));
+
+	return true;
+}
+
+uint32_t phx::World::FillBox(glm::ivec3 min, glm::ivec3 max, ChunkBlock block)
+{
+	const int shift = static_cast<int>(CHUNK_BLOCK_BIT_SIZE);
+
+	// Clip to the world so a box hanging over the edge only visits chunks that exist
+	const glm::ivec3 worldMin = mChunkGridMin << shift;
+	const glm::ivec3 worldMax = ((mChunkGridMin + glm::ivec3(MAX_WORLD_CHUNKS_PER_AXIS)) << shift) - 1;
+
+	const glm::ivec3 boxMin = glm::max(glm::min(min, max), worldMin);
+	const glm::ivec3 boxMax = glm::min(glm::max(min, max), worldMax);
+
+	if (glm::any(glm::greaterThan(boxMin, boxMax)))
+		return 0;
+
+	const BlockStateID state = mBlockStates->GetState(block);
+
+	uint32_t changed = 0;
+
+	// Walk chunk by chunk so every chunk is looked up once and filled with plain local loops
+	const glm::ivec3 chunkMin = boxMin >> shift;
+	const glm::ivec3 chunkMax = boxMax >> shift;
+
+	for (int cz = chunkMin.z; cz <= chunkMax.z; ++cz)
+	{
+		for (int cy = chunkMin.y; cy <= chunkMax.y; ++cy)
+		{
+			for (int cx = chunkMin.x; cx <= chunkMax.x; ++cx)
 			{
-				bool matchingAxies[3] = {newPos.x == lastPos.x, newPos.y == lastPos.y, newPos.z == lastPos.z};
+				const glm::ivec3 chunkPosition = glm::ivec3(cx, cy, cz);
 
-				int matchingAxiesCount = 0;
-				for (int j = 0; j < 3; j++)
-				{
-					if (matchingAxies[j])
-					{
-						matchingAxiesCount++;
-					}
-				}
+				Chunk* chunk = GetChunkAt(chunkPosition);
 
-				// If we have managed to get a block on a diaganal, 1 or axies of the cube will be touching the other one
-				if (matchingAxiesCount < 2)
-				{
-					// Half the current step size to try and catch the mixxing blocks
-					currentStep *= 0.5f;
-					// Since we are splitting a single step into two, we must add two back to the intteration count
-					i -= 2;
-					if (stepHalfCount < 2)
-					{
-						stepHalfCount++;
-						continue;
-					}
+				if (chunk == nullptr)
+					continue;
+
+				const glm::ivec3 chunkOrigin = chunkPosition << shift;
+				const glm::ivec3 localMin    = boxMin - chunkOrigin;
+				const glm::ivec3 localMax    = boxMax - chunkOrigin;
 
-					for (int j = matchingAxiesCount; j < 2; j++)
+				const glm::ivec3 begin = glm::max(localMin, glm::ivec3(0));
+				const glm::ivec3 end   = glm::min(localMax, glm::ivec3(CHUNK_BLOCK_SIZE - 1));
+
+				for (int x = begin.x; x <= end.x; ++x)
+				{
+					for (int y = begin.y; y <= end.y; ++y)
 					{
-						if (!matchingAxies[0])
+						for (int z = begin.z; z <= end.z; ++z)
 						{
-							matchingAxies[0] = true;
-							newPos.x = lastPos.x;
+							if (EditBlock(chunk, chunkPosition, glm::ivec3(x, y, z), state))
+								changed++;
 						}
-						else if (!matchingAxies[2])
-						{
-							matchingAxies[2] = true;
-							newPos.z = lastPos.z;
-						}
-						else if (!matchingAxies[1])
-						{
-							matchingAxies[1] = true;
-							newPos.y = lastPos.y;
-						}
-						matchingAxiesCount++;
 					}
 				}
-				stepHalfCount = 0;
-				currentStep = step;
+			}
+		}
+	}
 
-				// make sure after raycasting we are no longer outside the chunk, if we are find the new chunk
-				if (!PointToCube(viewPosition, chunk->GetPosition(), CHUNK_BLOCK_SIZE))
-				{
-					Chunk*             newChunk = nullptr;
-					phx::ChunkNeighbours* nabours  = chunk->GetNabours();
-					for (int j = 0; j < 6; j++)
-					{
-						if (nabours->neighbouringChunks[j] == nullptr)
-							continue;
+	return changed;
+}
 
-						if (PointToCube(viewPosition, (*nabours->neighbouringChunks[j])->GetPosition(), CHUNK_BLOCK_SIZE))
-						{
-							newChunk = *nabours->neighbouringChunks[j];
-							break;
-						}
-					}
-					// If we did not find a new chunk, we are off the edge of the map, break
-					if (newChunk == nullptr)
-						return;
+uint32_t phx::World::FillSphere(glm::vec3 centre, float radius, ChunkBlock block)
+{
+	if (radius < 0.0f)
+		return 0;
 
-					chunk = newChunk;
-				}
+	const int shift = static_cast<int>(CHUNK_BLOCK_BIT_SIZE);
 
-				unsigned int blockX = newPos.x;
-				unsigned int blockY = newPos.y;
-				unsigned int blockZ = newPos.z;
+	// Clip the sphere's bounds to the world the same way FillBox does
+	const glm::ivec3 worldMin = mChunkGridMin << shift;
+	const glm::ivec3 worldMax = ((mChunkGridMin + glm::ivec3(MAX_WORLD_CHUNKS_PER_AXIS)) << shift) - 1;
 
-				// Get local block index
-				blockX %= CHUNK_BLOCK_SIZE;
-				blockY %= CHUNK_BLOCK_SIZE;
-				blockZ %= CHUNK_BLOCK_SIZE;
+	const glm::ivec3 boxMin = glm::max(glm::ivec3(glm::floor(centre - radius)), worldMin);
+	const glm::ivec3 boxMax = glm::min(glm::ivec3(glm::floor(centre + radius)), worldMax);
 
-				ChunkBlock block = chunk->GetBlock(blockX, blockY, blockZ);
-				
-				// If the block is not air
-				if ( block != ModHandler::GetAirBlock())
+	if (glm::any(glm::greaterThan(boxMin, boxMax)))
+		return 0;
+
+	const BlockStateID state = mBlockStates->GetState(block);
+
+	const float radiusSquared = radius * radius;
+
+	uint32_t changed = 0;
+
+	const glm::ivec3 chunkMin = boxMin >> shift;
+	const glm::ivec3 chunkMax = boxMax >> shift;
+
+	for (int cz = chunkMin.z; cz <= chunkMax.z; ++cz)
+	{
+		for (int cy = chunkMin.y; cy <= chunkMax.y; ++cy)
+		{
+			for (int cx = chunkMin.x; cx <= chunkMax.x; ++cx)
+			{
+				const glm::ivec3 chunkPosition = glm::ivec3(cx, cy, cz);
+
+				Chunk* chunk = GetChunkAt(chunkPosition);
+
+				if (chunk == nullptr)
+					continue;
+
+				const glm::ivec3 chunkOrigin = chunkPosition << shift;
+
+				const glm::ivec3 begin = glm::max(boxMin - chunkOrigin, glm::ivec3(0));
+				const glm::ivec3 end   = glm::min(boxMax - chunkOrigin, glm::ivec3(CHUNK_BLOCK_SIZE - 1));
+
+				for (int x = begin.x; x <= end.x; ++x)
 				{
-					// If we are destroying a block, respond with the block we are wanting to destroy
-					if (mode == RaycastMode::Destroy)
+					for (int y = begin.y; y <= end.y; ++y)
 					{
-						chunkReturn = chunk;
-						localX      = blockX;
-						localY      = blockY;
-						localZ      = blockZ;
-						return;
-					}
-					// If we are in place mode, respond with the expected air block information
-					if (mode == RaycastMode::Place)
-					{							
-						chunkReturn = lastChunk;
-						localX      = lastLocalX;
-						localY      = lastLocalY;
-						localZ      = lastLocalZ;
-						return;
+						for (int z = begin.z; z <= end.z; ++z)
+						{
+							const glm::vec3 offset = glm::vec3(chunkOrigin + glm::ivec3(x, y, z)) + 0.5f - centre;
+
+							if (glm::dot(offset, offset) > radiusSquared)
+								continue;
+
+							if (EditBlock(chunk, chunkPosition, glm::ivec3(x, y, z), state))
+								changed++;
+						}
 					}
 				}
-				else
-				{
-					lastLocalX = blockX;
-					lastLocalY = blockY;
-					lastLocalZ = blockZ;
-					lastChunk  = chunk;
-				
-				}
-
-				lastPos = newPos;
 			}
 		}
 	}
+
+	return changed;
 }
 
-void phx::World::UpdateAllIndirectDraws()
+uint32_t phx::World::SetBlocksWorld(const std::vector<glm::ivec3>& blockPositions, ChunkBlock block)
 {
-	mIndirectDrawCommands->TransferInstantly(mIndirectBufferCPU.get(), sizeof(VkDrawIndirectCommand) * TOTAL_VERTEX_PAGE_COUNT);
+	const BlockStateID state = mBlockStates->GetState(block);
+
+	uint32_t changed = 0;
+
+	for (const glm::ivec3& blockPosition : blockPositions)
+	{
+		if (EditBlock(blockPosition, state))
+			changed++;
+	}
+
+	return changed;
 }
 
-void phx::World::UpdateAllPositionBuffers()
+bool phx::World::EditBlock(glm::ivec3 blockPosition, BlockStateID state)
 {
-	mPositionBuffer->TransferInstantly(mPositionBufferCPU.get(), sizeof(glm::mat4) * TOTAL_VERTEX_PAGE_COUNT);
+	const glm::ivec3 chunkPosition = blockPosition >> static_cast<int>(CHUNK_BLOCK_BIT_SIZE);
+
+	Chunk* chunk = GetChunkAt(chunkPosition);
+
+	if (chunk == nullptr)
+		return false;
+
+	const glm::ivec3 localPosition = glm::ivec3(blockPosition.x & CHUNK_BLOCK_BIT_SIZE_MASK, blockPosition.y & CHUNK_BLOCK_BIT_SIZE_MASK,
+	                                            blockPosition.z & CHUNK_BLOCK_BIT_SIZE_MASK);
+
+	return EditBlock(chunk, chunkPosition, localPosition, state);
 }
 
-void phx::World::ProcessVertexPages(VertexPage* pages, glm::mat4 position)
+bool phx::World::EditBlock(Chunk* chunk, glm::ivec3 chunkPosition, glm::ivec3 localPosition, BlockStateID state)
 {
-	while(pages != nullptr)
+	if (chunk->GetBlockState(localPosition.x, localPosition.y, localPosition.z) == state)
+		return false;
+
+	// Queues the block and the blocks around it inside the chunk for patching
+	chunk->SetBlockState(localPosition.x, localPosition.y, localPosition.z, state);
+
+	// A neighbour only meshes the faces that touch this chunk, so it can only change if the block is on that side,
+	// and then only the one block of it across the border
+	for (int axis = 0; axis < 3; ++axis)
 	{
+		glm::ivec3 offset         = glm::ivec3(0);
+		glm::ivec3 neighbourBlock = localPosition;
 
-		VkDrawIndirectCommand& indirectCommandInstance = mIndirectBufferCPU.get()[pages->index];
-		indirectCommandInstance.vertexCount            = pages->vertexCount;
-		indirectCommandInstance.instanceCount          = 1;
+		if (localPosition[axis] == 0)
+		{
+			offset[axis]         = -1;
+			neighbourBlock[axis] = CHUNK_BLOCK_SIZE - 1;
+		}
+		else if (localPosition[axis] == CHUNK_BLOCK_SIZE - 1)
+		{
+			offset[axis]         = 1;
+			neighbourBlock[axis] = 0;
+		}
+		else
+		{
+			continue;
+		}
 
-		// Transfer the indirect draw request
-		mIndirectDrawCommands->TransferInstantly(&indirectCommandInstance, sizeof(VkDrawIndirectCommand),
-		                                         pages->index * sizeof(VkDrawIndirectCommand));
+		Chunk* neighbour = GetChunkAt(chunkPosition + offset);
+
+		if (neighbour)
+			neighbour->MarkBlockDirty(neighbourBlock.x, neighbourBlock.y, neighbourBlock.z);
+	}
+
+	return true;
+}
+
+void phx::World::UpdateAllIndirectDraws()
+{
+	mIndirectDrawCommands->TransferInstantly(mIndirectBufferCPU.get(), sizeof(VkDrawIndexedIndirectCommand) * TOTAL_VERTEX_PAGE_COUNT);
+}
 
-		mPositionBufferCPU.get()[pages->index] = position;
-		mPositionBuffer->TransferInstantly(&mPositionBufferCPU.get()[pages->index], sizeof(glm::mat4), sizeof(glm::mat4) * pages->index);
+void phx::World::UpdateAllPageRecords()
+{
+	mPageRecordBuffer->TransferInstantly(mPageRecordsCPU.get(), sizeof(PageRecord) * TOTAL_VERTEX_PAGE_COUNT);
+}
+
+void phx::World::ProcessVertexPages(VertexPage* pages, glm::ivec3 origin)
+{
+	while(pages != nullptr)
+	{
+		ProcessVertexPage(pages, origin);
 
 		pages = pages->next;
 	}
-	UpdateAllPositionBuffers();
+}
+
+void phx::World::ProcessVertexPage(VertexPage* page, glm::ivec3 origin)
+{
+	VkDrawIndexedIndirectCommand& indirectCommandInstance = mIndirectBufferCPU[page->index];
+	indirectCommandInstance.indexCount                    = page->vertexCount / VERTICES_PER_FACE * INDICES_PER_FACE;
+	indirectCommandInstance.instanceCount                 = 1;
+	indirectCommandInstance.vertexOffset                  = static_cast<int32_t>(page->offset);
+
+	// Transfer the indirect draw request
+	mIndirectDrawCommands->TransferInstantly(&indirectCommandInstance, sizeof(VkDrawIndexedIndirectCommand),
+	                                         page->index * sizeof(VkDrawIndexedIndirectCommand));
+
+	PageRecord& pageRecord = mPageRecordsCPU[page->index];
+	pageRecord.origin      = origin;
+	pageRecord.flags       = (page->direction << PAGE_RECORD_DIRECTION_SHIFT) | (page->lod & PAGE_RECORD_LOD_MASK);
+	mPageRecordBuffer->TransferInstantly(&pageRecord, sizeof(PageRecord), sizeof(PageRecord) * page->index);
+
+	PageBounds& pageBounds = mPageBoundsCPU[page->index];
+	pageBounds.min         = glm::vec4(glm::vec3(origin) + page->boundsMin, 1.0f);
+	pageBounds.max         = glm::vec4(glm::vec3(origin) + page->boundsMax, 1.0f);
+	mPageBoundsBuffer->TransferInstantly(&pageBounds, sizeof(PageBounds), sizeof(PageBounds) * page->index);
 }
 
 void phx::World::FreeVertexPages(VertexPage* pages) 
@@ -563,19 +1147,20 @@ void phx::World::FreeVertexPages(VertexPage* pages)
 	{
 		next = pages->next;
 
-		VkDrawIndirectCommand& indirectCommandInstance = mIndirectBufferCPU.get()[pages->index];
-		indirectCommandInstance.vertexCount            = 0;
-		indirectCommandInstance.instanceCount          = 0;
+		VkDrawIndexedIndirectCommand& indirectCommandInstance = mIndirectBufferCPU[pages->index];
+		indirectCommandInstance.indexCount                    = 0;
+		indirectCommandInstance.instanceCount                 = 0;
 
 		// Transfer the indirect draw request
-		mIndirectDrawCommands->TransferInstantly(&mIndirectBufferCPU.get()[pages->index], sizeof(VkDrawIndirectCommand),
-		                                         pages->index * sizeof(VkDrawIndirectCommand));
+		mIndirectDrawCommands->TransferInstantly(&mIndirectBufferCPU[pages->index], sizeof(VkDrawIndexedIndirectCommand),
+		                                         pages->index * sizeof(VkDrawIndexedIndirectCommand));
+
 
+		mVertexAllocator->Free(pages->offset, pages->capacity);
 
 		pages->next = mFreeVertexPages;
 		mFreeVertexPages = pages;
 
-		mFreeMemoryPoolCount++;
 		pages = next;
 	}
 
@@ -30,13 +30,19 @@
 
 #pragma once
 
+#include <chrono>
 #include <memory>
+#include <vector>
 
 #include <Globals/Globals.hpp>
 
+#include <Phoenix/BlockStates.hpp>
+#include <Phoenix/Blocks.hpp>
+
 #include <Renderer/Vulkan.hpp>
 
 class Buffer;
+class Camera;
 class RenderDevice;
 class MemoryHeap;
 class ResourceManager;
@@ -45,14 +51,51 @@ class ResourceTable;
 namespace phx
 {
 	class Chunk;
+	class RegionStore;
+	class ThreadPool;
+	class VertexAllocator;
+	class WorldGenerator;
 	struct ChunkNeighbours;
 
 	struct VertexPage
 	{
 		uint32_t    index;
-		uint32_t    offset;
+		uint32_t    offset;   // First vertex of the page's range of the vertex buffer
+		uint32_t    capacity; // Vertices in the range, vertexCount can grow up to this without moving the page
 		uint32_t    vertexCount;
 		VertexPage* next;
+
+		// Chunk local bounds of the vertices written to the page
+		glm::vec3 boundsMin;
+		glm::vec3 boundsMax;
+
+		// Chunk::Face shared by every face in the page, or PAGE_DIRECTION_ANY
+		uint32_t direction;
+
+		// Level of detail the page was meshed at
+		uint32_t lod;
+	};
+
+	// Per page draw record, the vertex and culling shaders index it by page through firstInstance
+	struct PageRecord
+	{
+		glm::ivec3 origin; // Chunk origin in blocks, chunks are only ever translated
+		uint32_t   flags;  // LOD in PAGE_RECORD_LOD_MASK, the remaining bits are free for page flags
+	};
+
+	// World space page bounds as read by the culling shaders, vec4 to match the std430 layout
+	struct PageBounds
+	{
+		glm::vec4 min;
+		glm::vec4 max;
+	};
+
+	struct RaycastHit
+	{
+		bool       hit;
+		glm::ivec3 block;    // World position of the first solid block along the ray
+		glm::ivec3 previous; // Empty block the ray passed through right before it, where a new block would be placed
+		float      distance; // Distance along the ray to the face it entered the block through
 	};
 
 	class World
@@ -66,52 +109,187 @@ namespace phx
 
 		void Update();
 
-		void ComputeVisibility(VkCommandBuffer* commandBuffer, uint32_t index);
+		// Pages are culled in two phases. The early phase draws what was visible last frame, the late phase tests everything
+		// else against the depth pyramid built from the early phase and draws what has become visible.
+		enum CullingPhase
+		{
+			Early,
+			Late,
+			CullingPhaseCount
+		};
+
+		void ComputeVisibility(VkCommandBuffer* commandBuffer, uint32_t index, CullingPhase phase);
+
+		void Draw(VkCommandBuffer* commandBuffer, uint32_t index, CullingPhase phase);
+
+		// The sky only fills what is left, so it has to come after both world phases
+		void DrawSkybox(VkCommandBuffer* commandBuffer, uint32_t index);
+
+		// Takes a free page with room for at least vertexCount vertices for the owning chunk. Once the budget is used up the
+		// meshes of chunks farther from the camera than the owner are evicted to make room, returns nullptr when there
+		// are none left to evict.
+		VertexPage* AllocateVertexPage(uint32_t vertexCount, Chunk* owner);
+
+		// Whether an evicted mesh of vertexCount vertices would fit, either in the free budget or by evicting a farther one
+		bool CanAdmitMesh(Chunk* chunk, uint32_t vertexCount) const;
+
+		// Clamped to the size of the vertex buffer, meshes over a lowered budget are only evicted as new ones need room
+		void     SetVertexBudget(uint32_t vertexCount);
+		uint32_t GetVertexBudget() const;
+
+		// Meshes evicted to make room since start up
+		uint64_t GetEvictionCount() const;
+
+		// Chunks currently without a mesh because there was no room for it
+		uint32_t GetEvictedChunkCount() const;
+
+		const VertexAllocator* GetVertexAllocator() const;
+
+		// Drops every chunk mesh at once so the remeshes on the next Update pack them from the start of the vertex buffer
+		void DefragmentVertexMemory();
+
+		// Pages in the frustum that the late phase rejected, as of the last completed frame
+		unsigned int GetOccludedPageCount();
+
+		// Queues every chunk edited since it was last saved for writing to its region file
+		void SaveModifiedChunks();
+
+		// Saves every chunk, waits for the writes, then loads every chunk back into scratch memory. The results show up
+		// in the region store's throughput.
+		void BenchmarkRegionStore();
+
+		RegionStore* GetRegionStore();
+
+		// Times a face counting sweep over a copy of every chunk, once stored in LinearChunkLayout and once in
+		// MortonChunkLayout. Each sweep visits blocks in storage order and reads their six neighbours, like meshing does.
+		void BenchmarkChunkLayouts();
 
-		void Draw(VkCommandBuffer* commandBuffer, uint32_t index);
+		float GetLinearLayoutMilliseconds() const;
+		float GetMortonLayoutMilliseconds() const;
 
-		VertexPage* GetFreeVertexPage();
+		// Average cost of meshing a chunk from scratch, patched edits are not counted
+		float GetAverageMeshMilliseconds() const;
 
-		unsigned int GetFreeMemoryPoolCount();
+		WorldGenerator* GetGenerator();
 
 		void DestroyBlockFromView();
 
 		void PlaceBlockFromView();
 
+		// Walks every block the ray passes through in order until one is solid or maxDistance is reached
+		RaycastHit Raycast(glm::vec3 origin, glm::vec3 direction, float maxDistance) const;
+
+		// Casts one ray per origin and direction pair, spread across the thread pool
+		std::vector<RaycastHit> RaycastMany(const std::vector<glm::vec3>& origins, const std::vector<glm::vec3>& directions,
+		                                    float maxDistance) const;
+
+		// Chunk at the chunk coordinate, which is the world block position shifted down by CHUNK_BLOCK_BIT_SIZE.
+		// Returns nullptr outside of the world.
+		Chunk* GetChunkAt(glm::ivec3 chunkPosition) const;
+
+		// Blocks outside of the world read as air
+		ChunkBlock GetBlockWorld(glm::ivec3 blockPosition) const;
+
+		// Returns false if the block lies outside of the world, otherwise the affected chunks are queued for remeshing
+		bool SetBlockWorld(glm::ivec3 blockPosition, ChunkBlock block);
+
+		// Bulk edits write straight into chunk storage and only queue the chunks whose mesh can change, which is the chunk
+		// holding an edited block plus a neighbour when the block lies on their shared face. Queued chunks are patched or
+		// remeshed once on the next Update however many of their blocks were edited. Each returns the number of blocks changed.
+
+		// Fills every block between the two corners, both inclusive
+		uint32_t FillBox(glm::ivec3 min, glm::ivec3 max, ChunkBlock block);
+
+		// Fills every block whose centre lies within the radius
+		uint32_t FillSphere(glm::vec3 centre, float radius, ChunkBlock block);
+
+		uint32_t SetBlocksWorld(const std::vector<glm::ivec3>& blockPositions, ChunkBlock block);
+
 	private:
-		enum RaycastMode
-		{
-			Place,
-			Destroy
-		};
+		// Returns false when the block already held the state or lies outside of the world. Callers resolve the state once
+		// per edit, so a bulk edit does not go through the registry for every block.
+		bool EditBlock(glm::ivec3 blockPosition, BlockStateID state);
+
+		bool EditBlock(Chunk* chunk, glm::ivec3 chunkPosition, glm::ivec3 localPosition, BlockStateID state);
 
-		void RaycastToBlock(float step, int iteration, Chunk*& chunk, int& localX, int& localY, int& localZ, RaycastMode mode);
+		// Picks the level of detail of every chunk from its distance to the camera, and keeps the distance for eviction
+		void UpdateChunkLODs();
+
+		// Evicts the mesh of the chunk farthest from the camera, only if it is farther than minDistance
+		bool EvictFarthestMesh(float minDistance);
+
+		float GetChunkDistance(const Chunk* chunk) const;
 
 		void UpdateAllIndirectDraws();
 
-		void UpdateAllPositionBuffers();
+		void UpdateAllPageRecords();
+
+		void ProcessVertexPages(VertexPage* pages, glm::ivec3 origin);
 
-		void ProcessVertexPages(VertexPage* pages, glm::mat4 position);
+		void ProcessVertexPage(VertexPage* page, glm::ivec3 origin);
 
 		void FreeVertexPages(VertexPage* pages);
 
 		RenderDevice*           mDevice;
 		ResourceManager*        mResourceManager;
+		BlockStateRegistry*     mBlockStates;
+		Camera*                 mCamera;
+		ThreadPool*             mThreadPool;
 		std::unique_ptr<Buffer> mVertexBuffer;
 
-		std::unique_ptr<VertexPage> mVertexPages;
+		std::unique_ptr<VertexAllocator> mVertexAllocator;
+
+		uint32_t mVertexBudget;
+		uint64_t mEvictionCount = 0;
+
+		// Distance from the camera to the nearest point of every chunk, in mChunks order, as of the last Update
+		std::unique_ptr<float[]> mChunkDistances;
+		float                  mFarthestResidentDistance = 0.0f;
+
+		std::unique_ptr<VertexPage[]> mVertexPages;
 
 		VertexPage* mFreeVertexPages;
 
-		ResourceTable*                         mIndexedIndirectResourceTable;
-		std::unique_ptr<VkDrawIndirectCommand> mIndirectBufferCPU;
-		std::unique_ptr<Buffer>                mIndirectDrawCommands;
+		// Visible, non empty draws appended by one culling phase
+		struct CullingOutput
+		{
+			ResourceTable*          resourceTable;
+			std::unique_ptr<Buffer> drawCommands;
+			std::unique_ptr<Buffer> drawCount;
+		};
+
+		std::unique_ptr<VkDrawIndexedIndirectCommand[]> mIndirectBufferCPU;
+		std::unique_ptr<Buffer>                       mIndirectDrawCommands;
+
+		// Every page draws its quads with the same indices, offset to its own vertices through vertexOffset
+		std::unique_ptr<Buffer> mQuadIndexBuffer;
+
+		CullingOutput mCullingOutputs[CullingPhaseCount];
+
+		// One uint per page, written by the late phase and read by the next frame's early phase
+		std::unique_ptr<Buffer> mPageVisibility;
+		std::unique_ptr<Buffer> mCullingStatistics;
+
+		std::unique_ptr<RegionStore>    mRegionStore;
+		std::unique_ptr<WorldGenerator> mGenerator;
+
+		// One chunk of blocks in linear order, for moving chunks to and from the region store
+		std::unique_ptr<ChunkBlock[]> mBlockScratch;
+
+		std::chrono::steady_clock::time_point mLastSaveTime = std::chrono::steady_clock::now();
+
+		float mLinearLayoutMilliseconds = 0.0f;
+		float mMortonLayoutMilliseconds = 0.0f;
+
+		uint64_t mChunksMeshed     = 0;
+		uint64_t mMeshMicroseconds = 0;
 
 		ResourceTable*             mChunkPositionsResourceTable;
-		std::unique_ptr<glm::mat4> mPositionBufferCPU;
-		std::unique_ptr<Buffer>    mPositionBuffer;
+		std::unique_ptr<PageRecord[]> mPageRecordsCPU;
+		std::unique_ptr<Buffer>     mPageRecordBuffer;
 
-		unsigned int mFreeMemoryPoolCount;
+		std::unique_ptr<PageBounds[]> mPageBoundsCPU;
+		std::unique_ptr<Buffer>     mPageBoundsBuffer;
 
 		ChunkNeighbours* mChunkNeighbours;
 
@@ -120,6 +298,10 @@ namespace phx
 
 		// All chunks as they are allocated in memory
 		phx::Chunk* mChunks;
+
+		// Direct mapped from chunk coordinate, relative to the lowest chunk coordinate in the world
+		glm::ivec3   mChunkGridMin;
+		phx::Chunk** mChunkGrid;
 	};
 } // namespace phx
 
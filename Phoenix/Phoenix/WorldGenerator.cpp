@@ -0,0 +1,344 @@
+// BSD 3-Clause License
+// 
+// Copyright (c) 2022, Genten Studios
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#include <Phoenix/WorldGenerator.hpp>
+
+#include <Phoenix/Mods.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+
+// Lanes per noise batch, one row of a chunk
+static const unsigned int NOISE_BATCH = CHUNK_BLOCK_SIZE;
+
+// Column heights kept around before the cache starts over
+static const size_t MAX_CACHED_COLUMNS = 4096;
+
+// hard coded blocks.
+static constexpr phx::ChunkBlock DIRT  = {0x00000001};
+static constexpr phx::ChunkBlock STONE = {0x00010001};
+
+// Terrain shape, in blocks
+static const float TERRAIN_BASE_HEIGHT = -12.0f;
+static const float TERRAIN_AMPLITUDE   = 10.0f;
+static const float TERRAIN_FREQUENCY   = 1.0f / 64.0f;
+static const int   TERRAIN_OCTAVES     = 4;
+static const int   DIRT_DEPTH          = 3;
+
+// Caves follow where two noise fields both cross zero, which gives long winding tunnels
+static const float CAVE_FREQUENCY = 1.0f / 24.0f;
+static const float CAVE_WIDTH     = 0.09f;
+static const int   CAVE_ROOF      = 4;
+
+// The standard mod has no ores yet, so veins are pockets of dirt running through the stone
+static const float VEIN_FREQUENCY = 1.0f / 8.0f;
+static const float VEIN_THRESHOLD = 0.45f;
+
+// Integer hash of a lattice point, no permutation table so every lane can compute its own
+static inline uint32_t Hash(int32_t x, int32_t y, int32_t z, uint32_t seed)
+{
+	uint32_t h = seed ^ (static_cast<uint32_t>(x) * 0x8da6b343u) ^ (static_cast<uint32_t>(y) * 0xd8163841u) ^
+	             (static_cast<uint32_t>(z) * 0xcb1ab31fu);
+	h ^= h >> 16;
+	h *= 0x7feb352du;
+	h ^= h >> 15;
+	h *= 0x846ca68bu;
+	h ^= h >> 16;
+	return h;
+}
+
+// Dot product with a pseudo random gradient made from the bytes of the hash
+static inline float Gradient(uint32_t hash, float dx, float dy, float dz)
+{
+	const float gx = static_cast<float>(static_cast<int32_t>(hash & 0xFF) - 128);
+	const float gy = static_cast<float>(static_cast<int32_t>((hash >> 8) & 0xFF) - 128);
+	const float gz = static_cast<float>(static_cast<int32_t>((hash >> 16) & 0xFF) - 128);
+	return (gx * dx + gy * dy + gz * dz) * (1.0f / 128.0f);
+}
+
+static inline float Fade(float t) { return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f); }
+
+static inline float Lerp(float a, float b, float t) { return a + (b - a) * t; }
+
+// Gradient noise for a batch of points. The loop body is branch free so it vectorises across the lanes.
+static void GradientNoise3D(const float* x, const float* y, const float* z, uint32_t seed, float* out)
+{
+	for (unsigned int i = 0; i < NOISE_BATCH; i++)
+	{
+		const float x0 = std::floor(x[i]);
+		const float y0 = std::floor(y[i]);
+		const float z0 = std::floor(z[i]);
+
+		const int32_t ix = static_cast<int32_t>(x0);
+		const int32_t iy = static_cast<int32_t>(y0);
+		const int32_t iz = static_cast<int32_t>(z0);
+
+		const float fx = x[i] - x0;
+		const float fy = y[i] - y0;
+		const float fz = z[i] - z0;
+
+		const float n000 = Gradient(Hash(ix, iy, iz, seed), fx, fy, fz);
+		const float n100 = Gradient(Hash(ix + 1, iy, iz, seed), fx - 1.0f, fy, fz);
+		const float n010 = Gradient(Hash(ix, iy + 1, iz, seed), fx, fy - 1.0f, fz);
+		const float n110 = Gradient(Hash(ix + 1, iy + 1, iz, seed), fx - 1.0f, fy - 1.0f, fz);
+		const float n001 = Gradient(Hash(ix, iy, iz + 1, seed), fx, fy, fz - 1.0f);
+		const float n101 = Gradient(Hash(ix + 1, iy, iz + 1, seed), fx - 1.0f, fy, fz - 1.0f);
+		const float n011 = Gradient(Hash(ix, iy + 1, iz + 1, seed), fx, fy - 1.0f, fz - 1.0f);
+		const float n111 = Gradient(Hash(ix + 1, iy + 1, iz + 1, seed), fx - 1.0f, fy - 1.0f, fz - 1.0f);
+
+		const float u = Fade(fx);
+		const float v = Fade(fy);
+		const float w = Fade(fz);
+
+		out[i] = Lerp(Lerp(Lerp(n000, n100, u), Lerp(n010, n110, u), v), Lerp(Lerp(n001, n101, u), Lerp(n011, n111, u), v), w);
+	}
+}
+
+static void GradientNoise2D(const float* x, const float* z, uint32_t seed, float* out)
+{
+	for (unsigned int i = 0; i < NOISE_BATCH; i++)
+	{
+		const float x0 = std::floor(x[i]);
+		const float z0 = std::floor(z[i]);
+
+		const int32_t ix = static_cast<int32_t>(x0);
+		const int32_t iz = static_cast<int32_t>(z0);
+
+		const float fx = x[i] - x0;
+		const float fz = z[i] - z0;
+
+		const float n00 = Gradient(Hash(ix, 0, iz, seed), fx, 0.0f, fz);
+		const float n10 = Gradient(Hash(ix + 1, 0, iz, seed), fx - 1.0f, 0.0f, fz);
+		const float n01 = Gradient(Hash(ix, 0, iz + 1, seed), fx, 0.0f, fz - 1.0f);
+		const float n11 = Gradient(Hash(ix + 1, 0, iz + 1, seed), fx - 1.0f, 0.0f, fz - 1.0f);
+
+		const float u = Fade(fx);
+		const float w = Fade(fz);
+
+		out[i] = Lerp(Lerp(n00, n10, u), Lerp(n01, n11, u), w);
+	}
+}
+
+void phx::WorldGenerator::Generate(glm::ivec3 chunkPosition, ChunkBlock* blocks)
+{
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	GenerateChunk(chunkPosition, blocks);
+
+	mChunksGenerated++;
+	mGenerateMicroseconds +=
+	    std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+float phx::WorldGenerator::GetAverageChunkMilliseconds() const
+{
+	if (mChunksGenerated == 0)
+		return 0.0f;
+
+	return static_cast<float>(mGenerateMicroseconds) / static_cast<float>(mChunksGenerated) / 1000.0f;
+}
+
+void phx::FlatWorldGenerator::GenerateChunk(glm::ivec3 chunkPosition, ChunkBlock* blocks)
+{
+	const int originY = chunkPosition.y * CHUNK_BLOCK_SIZE;
+
+	for (int x = 0; x < CHUNK_BLOCK_SIZE; ++x)
+	{
+		for (int y = 0; y < CHUNK_BLOCK_SIZE; ++y)
+		{
+			const ChunkBlock block = originY + y < -5 ? DIRT : ModHandler::GetAirBlock();
+
+			for (int z = 0; z < CHUNK_BLOCK_SIZE; ++z)
+			{
+				blocks[(x * CHUNK_BLOCK_SIZE + y) * CHUNK_BLOCK_SIZE + z] = block;
+			}
+		}
+	}
+}
+
+phx::TerrainGenerator::TerrainGenerator(uint32_t seed) : mSeed(seed) {}
+
+void phx::TerrainGenerator::GenerateChunk(glm::ivec3 chunkPosition, ChunkBlock* blocks)
+{
+	const glm::ivec3 origin = chunkPosition * static_cast<int>(CHUNK_BLOCK_SIZE);
+
+	const ColumnHeights& column = GetColumnHeights(chunkPosition.x, chunkPosition.z);
+
+	// Entirely above the surface, nothing to evaluate
+	if (origin.y > column.maxHeight)
+	{
+		for (unsigned int i = 0; i < MAX_BLOCKS_PER_CHUNK; i++)
+		{
+			blocks[i] = ModHandler::GetAirBlock();
+		}
+		return;
+	}
+
+	float sampleX[NOISE_BATCH];
+	float sampleY[NOISE_BATCH];
+	float sampleZ[NOISE_BATCH];
+
+	float caveA[NOISE_BATCH];
+	float caveB[NOISE_BATCH];
+	float vein[NOISE_BATCH];
+
+	for (int x = 0; x < CHUNK_BLOCK_SIZE; ++x)
+	{
+		int rowMaxHeight = column.heights[x][0];
+		for (int z = 1; z < CHUNK_BLOCK_SIZE; ++z)
+		{
+			rowMaxHeight = std::max(rowMaxHeight, column.heights[x][z]);
+		}
+
+		for (int y = 0; y < CHUNK_BLOCK_SIZE; ++y)
+		{
+			const int worldY = origin.y + y;
+
+			ChunkBlock* row = &blocks[(x * CHUNK_BLOCK_SIZE + y) * CHUNK_BLOCK_SIZE];
+
+			// The whole row is air, skip the 3D noise
+			if (worldY > rowMaxHeight)
+			{
+				for (int z = 0; z < CHUNK_BLOCK_SIZE; ++z)
+				{
+					row[z] = ModHandler::GetAirBlock();
+				}
+				continue;
+			}
+
+			for (unsigned int z = 0; z < NOISE_BATCH; ++z)
+			{
+				sampleX[z] = static_cast<float>(origin.x + x) * CAVE_FREQUENCY;
+				sampleY[z] = static_cast<float>(worldY) * CAVE_FREQUENCY;
+				sampleZ[z] = static_cast<float>(origin.z + static_cast<int>(z)) * CAVE_FREQUENCY;
+			}
+
+			GradientNoise3D(sampleX, sampleY, sampleZ, mSeed + 1, caveA);
+			GradientNoise3D(sampleX, sampleY, sampleZ, mSeed + 2, caveB);
+
+			for (unsigned int z = 0; z < NOISE_BATCH; ++z)
+			{
+				sampleX[z] = static_cast<float>(origin.x + x) * VEIN_FREQUENCY;
+				sampleY[z] = static_cast<float>(worldY) * VEIN_FREQUENCY;
+				sampleZ[z] = static_cast<float>(origin.z + static_cast<int>(z)) * VEIN_FREQUENCY;
+			}
+
+			GradientNoise3D(sampleX, sampleY, sampleZ, mSeed + 3, vein);
+
+			for (int z = 0; z < CHUNK_BLOCK_SIZE; ++z)
+			{
+				const int depth = column.heights[x][z] - worldY;
+
+				if (depth < 0)
+				{
+					row[z] = ModHandler::GetAirBlock();
+				}
+				else if (depth >= CAVE_ROOF && std::abs(caveA[z]) < CAVE_WIDTH && std::abs(caveB[z]) < CAVE_WIDTH)
+				{
+					row[z] = ModHandler::GetAirBlock();
+				}
+				else if (depth < DIRT_DEPTH)
+				{
+					row[z] = DIRT;
+				}
+				else
+				{
+					row[z] = vein[z] > VEIN_THRESHOLD ? DIRT : STONE;
+				}
+			}
+		}
+	}
+}
+
+const phx::TerrainGenerator::ColumnHeights& phx::TerrainGenerator::GetColumnHeights(int chunkX, int chunkZ)
+{
+	const uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(chunkX)) << 32) | static_cast<uint32_t>(chunkZ);
+
+	auto it = mColumnHeights.find(key);
+	if (it != mColumnHeights.end())
+		return *it->second;
+
+	// Generation walks the world column by column, so a full cache mostly holds columns that are done with
+	if (mColumnHeights.size() >= MAX_CACHED_COLUMNS)
+		mColumnHeights.clear();
+
+	std::unique_ptr<ColumnHeights> column = std::unique_ptr<ColumnHeights>(new ColumnHeights());
+
+	const int originX = chunkX * static_cast<int>(CHUNK_BLOCK_SIZE);
+	const int originZ = chunkZ * static_cast<int>(CHUNK_BLOCK_SIZE);
+
+	float sampleX[NOISE_BATCH];
+	float sampleZ[NOISE_BATCH];
+	float octave[NOISE_BATCH];
+	float height[NOISE_BATCH];
+
+	column->maxHeight = std::numeric_limits<int32_t>::min();
+
+	for (int x = 0; x < CHUNK_BLOCK_SIZE; ++x)
+	{
+		for (unsigned int z = 0; z < NOISE_BATCH; ++z)
+		{
+			height[z] = 0.0f;
+		}
+
+		float frequency = TERRAIN_FREQUENCY;
+		float amplitude = 1.0f;
+
+		// Each octave doubles the detail and halves its weight
+		for (int o = 0; o < TERRAIN_OCTAVES; ++o)
+		{
+			for (unsigned int z = 0; z < NOISE_BATCH; ++z)
+			{
+				sampleX[z] = static_cast<float>(originX + x) * frequency;
+				sampleZ[z] = static_cast<float>(originZ + static_cast<int>(z)) * frequency;
+			}
+
+			GradientNoise2D(sampleX, sampleZ, mSeed + static_cast<uint32_t>(o) * 101u, octave);
+
+			for (unsigned int z = 0; z < NOISE_BATCH; ++z)
+			{
+				height[z] += octave[z] * amplitude;
+			}
+
+			frequency *= 2.0f;
+			amplitude *= 0.5f;
+		}
+
+		for (int z = 0; z < CHUNK_BLOCK_SIZE; ++z)
+		{
+			column->heights[x][z] = static_cast<int32_t>(std::floor(TERRAIN_BASE_HEIGHT + height[z] * TERRAIN_AMPLITUDE));
+			column->maxHeight     = std::max(column->maxHeight, column->heights[x][z]);
+		}
+	}
+
+	return *(mColumnHeights[key] = std::move(column));
+}
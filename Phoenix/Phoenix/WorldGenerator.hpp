@@ -0,0 +1,95 @@
+// BSD 3-Clause License
+// 
+// Copyright (c) 2022, Genten Studios
+// All rights reserved.
+// 
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+// 
+// 1. Redistributions of source code must retain the above copyright notice, this
+//    list of conditions and the following disclaimer.
+// 
+// 2. Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+// 
+// 3. Neither the name of the copyright holder nor the names of its
+//    contributors may be used to endorse or promote products derived from
+//    this software without specific prior written permission.
+// 
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+// DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+// FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+// DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+// SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+// OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+// OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+#pragma once
+
+#include <Globals/Globals.hpp>
+
+#include <Phoenix/Blocks.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+namespace phx
+{
+	// Fills chunks with the blocks they start out with. Generators are only called from the main thread.
+	class WorldGenerator
+	{
+	public:
+		virtual ~WorldGenerator() = default;
+
+		// Fills MAX_BLOCKS_PER_CHUNK blocks in LinearChunkLayout order for the chunk at the chunk position
+		void Generate(glm::ivec3 chunkPosition, ChunkBlock* blocks);
+
+		// Average cost of a chunk, has to stay well inside the budget for streaming chunks in
+		float GetAverageChunkMilliseconds() const;
+
+	protected:
+		virtual void GenerateChunk(glm::ivec3 chunkPosition, ChunkBlock* blocks) = 0;
+
+	private:
+		uint64_t mChunksGenerated      = 0;
+		uint64_t mGenerateMicroseconds = 0;
+	};
+
+	// Solid below a fixed height, the original placeholder world
+	class FlatWorldGenerator : public WorldGenerator
+	{
+	protected:
+		void GenerateChunk(glm::ivec3 chunkPosition, ChunkBlock* blocks) override;
+	};
+
+	// Rolling hills from layered 2D gradient noise, with 3D noise carving caves and scattering veins through the rock.
+	// Noise is evaluated a whole row of a chunk at a time, in fixed size batches the compiler can vectorise.
+	class TerrainGenerator : public WorldGenerator
+	{
+	public:
+		explicit TerrainGenerator(uint32_t seed);
+
+	protected:
+		void GenerateChunk(glm::ivec3 chunkPosition, ChunkBlock* blocks) override;
+
+	private:
+		// Surface height of every block column of a chunk column, in world blocks
+		struct ColumnHeights
+		{
+			int32_t heights[CHUNK_BLOCK_SIZE][CHUNK_BLOCK_SIZE];
+			int32_t maxHeight;
+		};
+
+		// Computed once per chunk column and shared by every chunk stacked in it
+		const ColumnHeights& GetColumnHeights(int chunkX, int chunkZ);
+
+		uint32_t mSeed;
+
+		std::unordered_map<uint64_t, std::unique_ptr<ColumnHeights>> mColumnHeights;
+	};
+} // namespace phx
@@ -103,6 +103,7 @@ void Camera::Update()
 	packet.modelToProjection        = m_projection * m_view;
 	packet.modelToWorld             = m_view;
 	packet.modelToProjectionInverse = glm::inverse(packet.modelToProjection);
+	packet.position                 = glm::vec4(m_position, 1.0f);
 
 	if (m_outOfDateFrustrum)
 	{
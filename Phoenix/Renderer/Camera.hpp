@@ -75,6 +75,7 @@ public:
 		glm::mat4 modelToWorld;      // Position
 		glm::mat4 modelToProjectionInverse;
 		glm::vec4 planes[6];
+		glm::vec4 position;
 	} packet;
 
 private:
@@ -360,14 +360,17 @@ void RenderDevice::BeginCommand(VkCommandBuffer commandBuffer, uint32_t flags) c
 	Validate(vkBeginCommandBuffer(commandBuffer, &commandBufferBeginInfo));
 }
 
-void RenderDevice::Present()
+void RenderDevice::AcquireNextImage()
 {
 	Validate(vkWaitForFences(m_device, 1, &m_swapchainImageFences[m_swapchainImageIndex], VK_TRUE, UINT32_MAX));
 
 	Validate(vkAcquireNextImageKHR(m_device, m_swapchain, UINT64_MAX, m_imageAvailableSemaphore, VK_NULL_HANDLE, &m_swapchainImageIndex));
 
 	Validate(vkQueueWaitIdle(m_graphicsQueue));
+}
 
+void RenderDevice::Present()
+{
 	Validate(vkResetFences(m_device, 1, &m_swapchainImageFences[m_swapchainImageIndex]));
 
 	m_renderSubmitInfo.pCommandBuffers = &m_primaryCommandBuffers[m_swapchainImageIndex];
@@ -453,6 +456,16 @@ void RenderDevice::SelectAndCreateDevice()
 		assert(0 && "Unable to get physical device");
 	}
 
+	std::vector<const char*> deviceExtensions(requiredDeviceExtensions, requiredDeviceExtensions + requiredDeviceExtensionCount);
+
+	// Optional extensions, the renderer falls back to a slower path when they are missing.
+	const char* drawIndirectCountExtension = VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME;
+	m_drawIndirectCountSupported           = HasRequiredExtensions(m_physicalDevice, &drawIndirectCountExtension, 1);
+	if (m_drawIndirectCountSupported)
+	{
+		deviceExtensions.push_back(drawIndirectCountExtension);
+	}
+
 	const float      queuePriority   = 1.0f;
 	VkDeviceQueueCreateInfo queueCreateInfo = {};
 	queueCreateInfo.sType                   = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
@@ -471,8 +484,8 @@ void RenderDevice::SelectAndCreateDevice()
 	deviceCreateInfo.pQueueCreateInfos       = &queueCreateInfo;
 	deviceCreateInfo.queueCreateInfoCount    = 1;
 	deviceCreateInfo.pEnabledFeatures        = &m_physicalDeviceFeatures;
-	deviceCreateInfo.enabledExtensionCount   = requiredDeviceExtensionCount;
-	deviceCreateInfo.ppEnabledExtensionNames = requiredDeviceExtensions;
+	deviceCreateInfo.enabledExtensionCount   = static_cast<uint32_t>(deviceExtensions.size());
+	deviceCreateInfo.ppEnabledExtensionNames = deviceExtensions.data();
 	deviceCreateInfo.pNext                   = &physicalDeviceDescriptorIndexingFeatures;
 
 	Validate(vkCreateDevice(m_physicalDevice, &deviceCreateInfo, nullptr, &m_device));
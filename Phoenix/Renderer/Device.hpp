@@ -75,6 +75,7 @@ public:
 	uint32_t     GetSwapchainImageCount() const { return m_swapchainImageCount; }
 	VkImageView* GetSwapchainImageViews() const { return m_swapchainImageViews.get(); }
 	VkImage*     GetSwapchainImages() const { return m_swapchainImages.get(); }
+	uint32_t     GetSwapchainImageIndex() const { return m_swapchainImageIndex; }
 
 	VkFormat GetSurfaceFormat() const { return m_surfaceFormat.format; }
 	VkFormat GetColorFormat() const { return m_colorFormat; }
@@ -92,7 +93,10 @@ public:
 	VkFormat FindSupportedFormat(const VkFormat* candidateFormats, const uint32_t candidateFormatCount, VkImageTiling tiling,
 	                             VkFormatFeatureFlags features) const;
 
-	VkQueue GetGraphicsQueue() const { return m_graphicsQueue; }
+	VkQueue  GetGraphicsQueue() const { return m_graphicsQueue; }
+	uint32_t GetGraphicsQueueFamily() const { return m_physicalDevicesQueueFamily; }
+
+	bool SupportsDrawIndirectCount() const { return m_drawIndirectCountSupported; }
 
 	VkCommandBuffer* GetPrimaryCommandBuffers() const { return m_primaryCommandBuffers.get(); }
 	VkCommandBuffer  CreateSingleTimeCommand();
@@ -105,6 +109,9 @@ public:
 
 	ResourceTableLayout* GetPostProcessSampler() const;
 
+	// Acquires the image the next Present submits for, its command buffer is idle once this returns
+	void AcquireNextImage();
+
 	void Present();
 
 	void WindowChange(uint32_t width, uint32_t height);
@@ -167,6 +174,8 @@ private:
 	VkQueue       m_graphicsQueue              = VK_NULL_HANDLE;
 	uint32_t      m_physicalDevicesQueueFamily = 0;
 
+	bool m_drawIndirectCountSupported = false;
+
 	std::unique_ptr<VkCommandBuffer[]> m_primaryCommandBuffers;
 
 	VkPipelineStageFlags m_renderWaitStage = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
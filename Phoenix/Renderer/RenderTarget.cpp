@@ -39,11 +39,14 @@
 #include <Renderer/ResourceTableLayout.hpp>
 #include <Renderer/Texture.hpp>
 
-RenderTarget::RenderTarget(RenderDevice* device, uint32_t width, uint32_t height, bool useDepth) : m_device(device), m_useDepth(useDepth)
+RenderTarget::RenderTarget(RenderDevice* device, uint32_t width, uint32_t height, bool useDepth, bool renderToSwapchain)
+    : m_device(device), m_useDepth(useDepth), m_renderToSwapchain(renderToSwapchain)
 {
 	m_format = m_device->GetSurfaceFormat();
 	CreateRenderTarget(width, height);
 	m_renderpass = std::unique_ptr<RenderPass>(new RenderPass(m_device, width, height, m_framebufferAttachment.get()));
+	m_loadRenderpass = std::unique_ptr<RenderPass>(
+	    new RenderPass(m_device, width, height, m_framebufferAttachment.get(), false, m_renderToSwapchain));
 }
 
 RenderTarget::RenderTarget(RenderDevice* device, uint32_t width, uint32_t height, VkFormat format, bool useDepth)
@@ -51,12 +54,14 @@ RenderTarget::RenderTarget(RenderDevice* device, uint32_t width, uint32_t height
 {
 	CreateRenderTarget(width, height);
 	m_renderpass = std::unique_ptr<RenderPass>(new RenderPass(m_device, width, height, m_framebufferAttachment.get()));
+	m_loadRenderpass = std::unique_ptr<RenderPass>(new RenderPass(m_device, width, height, m_framebufferAttachment.get(), false));
 }
 
 RenderTarget::~RenderTarget()
 {
 	DestroyRenderTarget();
 	m_renderpass.reset();
+	m_loadRenderpass.reset();
 	m_samplerResourceTable.reset();
 	m_depthImage.reset();
 	m_depthFramebufferPacket.reset();
@@ -64,13 +69,18 @@ RenderTarget::~RenderTarget()
 
 RenderPass* RenderTarget::GetRenderPass() const { return m_renderpass.get(); }
 
+RenderPass* RenderTarget::GetLoadRenderPass() const { return m_loadRenderpass.get(); }
+
 Texture* RenderTarget::GetImage() const { return m_image.get(); }
 
+Texture* RenderTarget::GetDepthImage() const { return m_depthImage.get(); }
+
 void RenderTarget::ScreenResize(uint32_t width, uint32_t height)
 {
 	DestroyRenderTarget();
 	CreateRenderTarget(width, height);
 	m_renderpass->Rebuild(m_framebufferAttachment.get(), width, height);
+	m_loadRenderpass->Rebuild(m_framebufferAttachment.get(), width, height);
 }
 
 void RenderTarget::StartRendering(VkCommandBuffer* commandBuffer, uint32_t index) const
@@ -78,14 +88,14 @@ void RenderTarget::StartRendering(VkCommandBuffer* commandBuffer, uint32_t index
 	VkViewport viewport = {};
 	viewport.x          = 0;
 	viewport.y          = 0;
-	viewport.width      = (float) m_image->GetWidth();
-	viewport.height     = (float) m_image->GetHeight();
+	viewport.width      = (float) m_width;
+	viewport.height     = (float) m_height;
 	viewport.minDepth   = 0.0f;
 	viewport.maxDepth   = 1.0f;
 
 	VkRect2D scissor {};
-	scissor.extent.width  = m_image->GetWidth();
-	scissor.extent.height = m_image->GetHeight();
+	scissor.extent.width  = m_width;
+	scissor.extent.height = m_height;
 	scissor.offset.x      = 0;
 	scissor.offset.y      = 0;
 
@@ -109,18 +119,32 @@ void RenderTarget::StopSampling(VkCommandBuffer* commandBuffer, uint32_t index)
 
 void RenderTarget::CreateRenderTarget(uint32_t width, uint32_t height)
 {
-	m_image = std::make_unique<Texture>(m_device, width, height, m_format,
-	                                    VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT |
-	                                    VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
-	                                    nullptr);
+	m_width  = width;
+	m_height = height;
 
-	m_framebufferPacket = std::make_unique<FramebufferPacket>(m_image.get(), 1, m_format, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
-	                                                          EFramebufferImageType::Color);
+	if (m_renderToSwapchain)
+	{
+		// Each framebuffer picks the view of its own swapchain image
+		m_framebufferPacket =
+		    std::make_unique<FramebufferPacket>(m_device->GetSwapchainImageViews(), m_device->GetSwapchainImageCount(), m_format,
+		                                        VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, EFramebufferImageType::Color);
+	}
+	else
+	{
+		m_image = std::make_unique<Texture>(m_device, width, height, m_format,
+		                                    VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT |
+		                                    VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+		                                    nullptr);
+
+		m_framebufferPacket = std::make_unique<FramebufferPacket>(m_image.get(), 1, m_format, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+		                                                          EFramebufferImageType::Color);
+	}
 
 	if (m_useDepth)
 	{
 		m_depthImage = std::make_unique<Texture>(m_device, width, height, m_device->GetDepthFormat(),
-		                                         VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT,
+		                                         VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT |
+		                                         VK_IMAGE_USAGE_SAMPLED_BIT,
 		                                         nullptr);
 
 		m_depthFramebufferPacket = std::make_unique<FramebufferPacket>(
@@ -134,6 +158,10 @@ void RenderTarget::CreateRenderTarget(uint32_t width, uint32_t height)
 		m_framebufferAttachment = std::unique_ptr<FramebufferAttachment>(new FramebufferAttachment(m_device, {m_framebufferPacket.get()}));
 	}
 
+	// The swapchain images are never sampled
+	if (m_image == nullptr)
+		return;
+
 	if (m_samplerResourceTable == nullptr)
 	{
 		m_samplerResourceTable = std::unique_ptr<ResourceTable>(m_device->GetPostProcessSampler()->CreateTable());
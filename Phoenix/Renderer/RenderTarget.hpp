@@ -47,12 +47,16 @@ class Pipeline;
 class RenderTarget
 {
 public:
-	RenderTarget(RenderDevice* device, uint32_t width, uint32_t height, bool useDepth = false);
+	// With renderToSwapchain the target renders straight into the swapchain images instead of its own color image, and its
+	// load render pass leaves the swapchain image ready to present
+	RenderTarget(RenderDevice* device, uint32_t width, uint32_t height, bool useDepth = false, bool renderToSwapchain = false);
 	RenderTarget(RenderDevice* device, uint32_t width, uint32_t height, VkFormat format, bool useDepth = false);
 	~RenderTarget();
 
 	RenderPass* GetRenderPass() const;
+	RenderPass* GetLoadRenderPass() const;
 	Texture*    GetImage() const;
+	Texture*    GetDepthImage() const;
 
 	void ScreenResize(uint32_t width, uint32_t height);
 
@@ -68,6 +72,7 @@ private:
 
 	RenderDevice*                          m_device;
 	std::unique_ptr<RenderPass>            m_renderpass;
+	std::unique_ptr<RenderPass>            m_loadRenderpass;
 	std::unique_ptr<Texture>               m_image;
 	std::unique_ptr<Texture>               m_depthImage;
 	std::unique_ptr<FramebufferPacket>     m_framebufferPacket;
@@ -75,6 +80,9 @@ private:
 	std::unique_ptr<FramebufferAttachment> m_framebufferAttachment;
 	std::unique_ptr<ResourceTable>         m_samplerResourceTable;
 	VkFormat                               m_format;
+	uint32_t                               m_width;
+	uint32_t                               m_height;
 	bool                                   m_useDepth;
+	bool                                   m_renderToSwapchain = false;
 };
 
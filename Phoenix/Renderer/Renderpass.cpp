@@ -35,7 +35,8 @@
 #include <cassert>
 #include <cstring>
 
-RenderPass::RenderPass(RenderDevice* device, uint32_t width, uint32_t height, FramebufferAttachment* framebufferAttachment)
+RenderPass::RenderPass(RenderDevice* device, uint32_t width, uint32_t height, FramebufferAttachment* framebufferAttachment,
+                       bool clearAttachments, bool presentColor)
     : m_device(device), m_width(width), m_height(height), m_framebufferAttachment(framebufferAttachment)
 {
 	std::vector<VkAttachmentDescription> colorAttachments;
@@ -52,12 +53,12 @@ RenderPass::RenderPass(RenderDevice* device, uint32_t width, uint32_t height, Fr
 			VkAttachmentDescription colorAttachment = {};
 			colorAttachment.format                  = packet->GetFormat();
 			colorAttachment.samples                 = VK_SAMPLE_COUNT_1_BIT;
-			colorAttachment.loadOp                  = VK_ATTACHMENT_LOAD_OP_CLEAR;
+			colorAttachment.loadOp                  = clearAttachments ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
 			colorAttachment.storeOp                 = VK_ATTACHMENT_STORE_OP_STORE;
 			colorAttachment.stencilLoadOp           = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 			colorAttachment.stencilStoreOp          = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-			colorAttachment.initialLayout           = VK_IMAGE_LAYOUT_UNDEFINED;
-			colorAttachment.finalLayout             = packet->GetImageLayout();
+			colorAttachment.initialLayout           = clearAttachments ? VK_IMAGE_LAYOUT_UNDEFINED : packet->GetImageLayout();
+			colorAttachment.finalLayout             = presentColor ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR : packet->GetImageLayout();
 
 			colorAttachments.push_back(colorAttachment);
 
@@ -78,11 +79,11 @@ RenderPass::RenderPass(RenderDevice* device, uint32_t width, uint32_t height, Fr
 			VkAttachmentDescription depthAttachment = {};
 			depthAttachment.format                  = packet->GetFormat();
 			depthAttachment.samples                 = VK_SAMPLE_COUNT_1_BIT;
-			depthAttachment.loadOp                  = VK_ATTACHMENT_LOAD_OP_CLEAR;
-			depthAttachment.storeOp                 = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+			depthAttachment.loadOp                  = clearAttachments ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
+			depthAttachment.storeOp                 = VK_ATTACHMENT_STORE_OP_STORE; // Read back by the depth pyramid
 			depthAttachment.stencilLoadOp           = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
 			depthAttachment.stencilStoreOp          = VK_ATTACHMENT_STORE_OP_DONT_CARE;
-			depthAttachment.initialLayout           = VK_IMAGE_LAYOUT_UNDEFINED;
+			depthAttachment.initialLayout           = clearAttachments ? VK_IMAGE_LAYOUT_UNDEFINED : packet->GetImageLayout();
 			depthAttachment.finalLayout             = packet->GetImageLayout();
 
 			colorAttachments.push_back(depthAttachment);
@@ -121,7 +122,7 @@ RenderPass::RenderPass(RenderDevice* device, uint32_t width, uint32_t height, Fr
 	subpassDependency.dstSubpass          = 0;
 	subpassDependency.srcStageMask        = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 	subpassDependency.dstStageMask        = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-	subpassDependency.srcAccessMask       = 0;
+	subpassDependency.srcAccessMask       = clearAttachments ? 0 : VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 	subpassDependency.dstAccessMask       = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 	subpassDependency.dependencyFlags     = VK_DEPENDENCY_BY_REGION_BIT;
 
@@ -145,7 +146,7 @@ RenderPass::~RenderPass()
 	vkDestroyRenderPass(m_device->GetDevice(), m_renderpass, nullptr);
 }
 
-void RenderPass::Use(VkCommandBuffer* commandBuffer, uint32_t index) const
+void RenderPass::Use(VkCommandBuffer* commandBuffer, uint32_t index, VkSubpassContents contents) const
 {
 	const float clearColorImage[4]   = {0.0f, 0.0f, 0.0f, 1.0f};
 	const float clearColorPresent[4] = {1.0f, 1.0f, 1.0f, 1.0f};
@@ -166,7 +167,7 @@ void RenderPass::Use(VkCommandBuffer* commandBuffer, uint32_t index) const
 
 	renderPassInfo.framebuffer = m_framebuffers[index];
 
-	vkCmdBeginRenderPass(commandBuffer[index], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+	vkCmdBeginRenderPass(commandBuffer[index], &renderPassInfo, contents);
 }
 
 VkRenderPass RenderPass::GetRenderPass() const { return m_renderpass; }
@@ -41,10 +41,13 @@ class FramebufferPacket;
 class RenderPass
 {
 public:
-	RenderPass(RenderDevice* device, uint32_t width, uint32_t height, FramebufferAttachment* framebufferAttachment);
+	// When clearAttachments is false the pass loads and continues the contents left by a previous pass over the same attachments.
+	// When presentColor is set the color attachments are left ready for presenting.
+	RenderPass(RenderDevice* device, uint32_t width, uint32_t height, FramebufferAttachment* framebufferAttachment,
+	           bool clearAttachments = true, bool presentColor = false);
 	~RenderPass();
 
-	void Use(VkCommandBuffer* commandBuffer, uint32_t index) const;
+	void Use(VkCommandBuffer* commandBuffer, uint32_t index, VkSubpassContents contents = VK_SUBPASS_CONTENTS_INLINE) const;
 
 	VkRenderPass   GetRenderPass() const;
 	VkFramebuffer* GetFrameBuffers() const;
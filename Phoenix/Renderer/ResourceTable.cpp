@@ -92,3 +92,20 @@ void ResourceTable::Bind(uint32_t binding, Texture* texture, uint32_t arrayEleme
 	vkUpdateDescriptorSets(m_device->GetDevice(), 1, &descriptorWrite, 0, nullptr);
 }
 
+
+void ResourceTable::Bind(uint32_t binding, const VkDescriptorImageInfo& descriptorImageInfo, uint32_t arrayElement) const
+{
+	VkWriteDescriptorSet descriptorWrite = {};
+	descriptorWrite.sType                = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	descriptorWrite.dstSet               = m_descriptorSet;
+	descriptorWrite.dstBinding           = binding;
+	descriptorWrite.dstArrayElement      = arrayElement;
+	descriptorWrite.descriptorType       = m_resourceTableLayout->GetDescriptorType(binding);
+	descriptorWrite.descriptorCount      = 1;
+	descriptorWrite.pBufferInfo          = VK_NULL_HANDLE;
+	descriptorWrite.pImageInfo           = &descriptorImageInfo;
+	descriptorWrite.pTexelBufferView     = VK_NULL_HANDLE;
+	descriptorWrite.pNext                = VK_NULL_HANDLE;
+
+	vkUpdateDescriptorSets(m_device->GetDevice(), 1, &descriptorWrite, 0, nullptr);
+}
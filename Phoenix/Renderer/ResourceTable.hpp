@@ -50,6 +50,7 @@ public:
 
 	void Bind(uint32_t binding, Buffer* buffer) const;
 	void Bind(uint32_t binding, Texture* texture, uint32_t arrayElement = 0) const;
+	void Bind(uint32_t binding, const VkDescriptorImageInfo& descriptorImageInfo, uint32_t arrayElement = 0) const;
 
 private:
 	RenderDevice*        m_device;
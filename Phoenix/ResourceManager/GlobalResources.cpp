@@ -79,19 +79,43 @@ void CreateGlobalResources(RenderDevice* device, ResourceManager* resourceManage
 	}
 
 	{
+		// Page records and page bounds
 		VkDescriptorSetLayoutBinding descriptorPoolSizes[] = {
-		    {0, VkDescriptorType::VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT}};
-		ResourceTableLayout* resourceTableLayout = new ResourceTableLayout(device, descriptorPoolSizes, 1, 100);
+		    {0, VkDescriptorType::VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT},
+		    {1, VkDescriptorType::VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_COMPUTE_BIT}};
+		ResourceTableLayout* resourceTableLayout = new ResourceTableLayout(device, descriptorPoolSizes, 2, 100);
 		resourceManager->RegisterResource<ResourceTableLayout>("ChunkPositionResourceTableLayout", resourceTableLayout);
 	}
 
 	{
+		// All draw commands, the compacted visible draw commands, the visible draw count, the per page visibility from the
+		// previous frame and the culling statistics
 		VkDescriptorSetLayoutBinding descriptorPoolSizes[] = {
-		    {0, VkDescriptorType::VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT}};
-		ResourceTableLayout* resourceTableLayout = new ResourceTableLayout(device, descriptorPoolSizes, 1, 100);
+		    {0, VkDescriptorType::VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT},
+		    {1, VkDescriptorType::VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT},
+		    {2, VkDescriptorType::VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT},
+		    {3, VkDescriptorType::VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT},
+		    {4, VkDescriptorType::VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT}};
+		ResourceTableLayout* resourceTableLayout = new ResourceTableLayout(device, descriptorPoolSizes, 5, 100);
 		resourceManager->RegisterResource<ResourceTableLayout>("IndexedIndirectCommandResourceTableLayout", resourceTableLayout);
 	}
 
+	{
+		// Source depth level and destination level of a single depth pyramid reduction
+		VkDescriptorSetLayoutBinding descriptorPoolSizes[] = {
+		    {0, VkDescriptorType::VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT},
+		    {1, VkDescriptorType::VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1, VK_SHADER_STAGE_COMPUTE_BIT}};
+		ResourceTableLayout* resourceTableLayout = new ResourceTableLayout(device, descriptorPoolSizes, 2, MAX_DEPTH_PYRAMID_LEVELS);
+		resourceManager->RegisterResource<ResourceTableLayout>("DepthPyramidReduceResourceTableLayout", resourceTableLayout);
+	}
+
+	{
+		VkDescriptorSetLayoutBinding descriptorPoolSizes[] = {
+		    {0, VkDescriptorType::VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_COMPUTE_BIT}};
+		ResourceTableLayout* resourceTableLayout = new ResourceTableLayout(device, descriptorPoolSizes, 1, 1);
+		resourceManager->RegisterResource<ResourceTableLayout>("DepthPyramidResourceTableLayout", resourceTableLayout);
+	}
+
 	{
 		VkDescriptorSetLayoutBinding descriptorPoolSizes[] = {
 		    {0, VkDescriptorType::VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, VK_SHADER_STAGE_COMPUTE_BIT}};
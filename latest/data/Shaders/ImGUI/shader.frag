@@ -7,11 +7,18 @@ layout (set = 0, binding = 0) uniform sampler2D[100] textures;
 layout (location = 0) in vec2 inUV;
 layout (location = 1) in vec4 inColor;
 layout (location = 2) flat in int inTexID;
+layout (location = 3) flat in vec4 inClipRect;
 
 layout (location = 0) out vec4 outColor;
 
 void main() 
 {
+	// Per draw clip area in framebuffer pixels, replaces a per draw scissor
+	if (any(lessThan(gl_FragCoord.xy, inClipRect.xy)) || any(greaterThanEqual(gl_FragCoord.xy, inClipRect.zw)))
+	{
+		discard;
+	}
+
 	outColor = inColor;
 	if(inTexID > 0)
 	{
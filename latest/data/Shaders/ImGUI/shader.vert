@@ -4,6 +4,7 @@ layout(location = 0) in vec2 inPos;
 layout(location = 1) in vec2 inUV;
 layout(location = 2) in vec4 inColor;
 layout(location = 3) in int inTexID;
+layout(location = 4) in vec4 inClipRect;
 
 layout(set = 1, binding = 0) uniform UniformBufferObjectStatic
 {
@@ -13,12 +14,14 @@ layout(set = 1, binding = 0) uniform UniformBufferObjectStatic
 layout(location = 0) out vec2 outUV;
 layout(location = 1) out vec4 outColor;
 layout(location = 2) out int outTexID;
+layout(location = 3) out vec4 outClipRect;
 
 void main() 
 {
 	outUV = inUV;
 	outColor = inColor;
 	outTexID = inTexID;
+	outClipRect = inClipRect;
 
 	gl_Position = vec4(inPos * vec2(2.0f / ScreenDim.x, 2.0f / ScreenDim.y) + vec2(-1.0,-1.0), 0.0, 1.0);
 }
@@ -5,14 +5,13 @@
 #extension GL_GOOGLE_include_directive : require
 
 #include "../_includes/Camera.glsl"
+#include "../_includes/ChunkPositions.glsl"
 
 layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inNormal;
 layout(location = 2) in vec2 inUV;
 layout(location = 3) in int inTextureID;
 
-layout(location = 4) in mat4  modelMatrix;
-
 layout(location = 0) out vec2 outUV;
 layout(location = 1) out int outTextureID;
 layout(location = 2) out vec3 outNormal;
@@ -21,7 +20,10 @@ void main()
 {
 	outUV = inUV;
 	outTextureID = inTextureID;
-	outNormal = (modelMatrix * vec4(inNormal, 0.0f)).xyz;
+	// Chunks are only translated, so normals stay as they are
+	outNormal = inNormal;
+
+	vec3 origin = vec3(pageRecords[gl_InstanceIndex].origin);
 
-	gl_Position = CalculateCamera(modelMatrix * vec4(inPosition,1.0f));
+	gl_Position = CalculateCamera(vec4(inPosition + origin, 1.0f));
 }
@@ -4,6 +4,7 @@ struct Camera
     mat4 modelToWorld;
     mat4 modelToProjectionInverse;
 	vec4 frustumPlanes[6];
+	vec4 position;
 };
 
 layout (binding = 0, set = 0) readonly uniform CameraBuffer { Camera camera; };
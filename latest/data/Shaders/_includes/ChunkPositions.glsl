@@ -1,9 +1,30 @@
-struct ChunkPositions
+// Must match PAGE_RECORD_* and PAGE_DIRECTION_ANY in Globals.hpp
+const uint PAGE_RECORD_LOD_MASK = 15;
+const uint PAGE_RECORD_DIRECTION_SHIFT = 4;
+const uint PAGE_RECORD_DIRECTION_MASK = 7;
+const uint PAGE_DIRECTION_ANY = 6;
+
+// Must match phx::PageRecord in World.hpp
+struct PageRecord
+{
+	ivec3 origin;
+	uint flags;
+};
+
+// Indexed by page, which is the draw's firstInstance
+layout(std430, set=1, binding=0) readonly buffer PageRecordBuffer
+{
+		PageRecord pageRecords[];
+};
+
+struct PageBounds
 {
-	mat4 position;
+	vec4 boundsMin;
+	vec4 boundsMax;
 };
 
-layout(std430, set=1, binding=0) buffer ChunkPositionsBuffer
+// World space bounds of the vertices in each page
+layout(std430, set=1, binding=1) readonly buffer PageBoundsBuffer
 {
-		ChunkPositions chunkPositions[];
+		PageBounds pageBounds[];
 };
@@ -1,4 +0,0 @@
-const float CHUNK_WIDTH = 16;
-
-// Pythagorus -> sqrt(size^2 + size^2)
-const float SPHERICAL_CHUNK_RADIUS = sqrt(CHUNK_WIDTH * CHUNK_WIDTH + CHUNK_WIDTH * CHUNK_WIDTH);
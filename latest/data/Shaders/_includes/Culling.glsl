@@ -0,0 +1,93 @@
+// Shared by the early (ViewFrustrumCulling) and late (OcclusionCulling) culling passes.
+// Needs Camera.glsl, ChunkPositions.glsl and IndirectCommand.glsl included first.
+
+layout(std430, set=2, binding=0) readonly buffer VkDrawIndexedIndirectCommandBuffer
+{
+		VkDrawIndexedIndirectCommand drawIndirectCommand[];
+};
+
+layout(std430, set=2, binding=1) writeonly buffer VisibleDrawIndirectCommandBuffer
+{
+		VkDrawIndexedIndirectCommand visibleDrawIndirectCommand[];
+};
+
+layout(std430, set=2, binding=2) buffer VisibleDrawCountBuffer
+{
+		uint visibleDrawCount;
+};
+
+// Non zero when the page passed the occlusion test in the previous frame's late pass
+layout(std430, set=2, binding=3) buffer PageVisibilityBuffer
+{
+		uint pageVisibility[];
+};
+
+layout(std430, set=2, binding=4) buffer CullingStatisticsBuffer
+{
+		uint occludedPageCount;
+};
+
+bool IsBoxInFrustum(vec3 boundsMin, vec3 boundsMax)
+{
+	for (int i = 0; i < 6; ++i)
+	{
+		// Corner of the box furthest along the plane normal, if it is behind the plane the whole box is
+		vec3 positiveCorner = mix(boundsMin, boundsMax, greaterThanEqual(camera.frustumPlanes[i].xyz, vec3(0.0)));
+
+		if (dot(positiveCorner, camera.frustumPlanes[i].xyz) + camera.frustumPlanes[i].w < 0.0)
+			return false;
+	}
+
+	return true;
+}
+
+bool IsPageInFrustum(uint idx)
+{
+	return IsBoxInFrustum(pageBounds[idx].boundsMin.xyz, pageBounds[idx].boundsMax.xyz);
+}
+
+// Outward normal of each Chunk::Face, every face in a page points the same way
+const vec3 FACE_NORMALS[6] = vec3[](
+	vec3(1.0, 0.0, 0.0), vec3(-1.0, 0.0, 0.0),
+	vec3(0.0, -1.0, 0.0), vec3(0.0, 1.0, 0.0),
+	vec3(0.0, 0.0, -1.0), vec3(0.0, 0.0, 1.0));
+
+bool IsPageFacingCamera(uint idx)
+{
+	uint direction = (pageRecords[idx].flags >> PAGE_RECORD_DIRECTION_SHIFT) & PAGE_RECORD_DIRECTION_MASK;
+
+	// Coarse level of detail pages mix faces of every direction
+	if (direction == PAGE_DIRECTION_ANY)
+		return true;
+
+	vec3 normal = FACE_NORMALS[direction];
+
+	// Rearmost face plane of the page, the camera has to be in front of it to see any face in the page
+	vec3 rearCorner = mix(pageBounds[idx].boundsMax.xyz, pageBounds[idx].boundsMin.xyz, greaterThan(normal, vec3(0.0)));
+
+	return dot(camera.position.xyz - rearCorner, normal) > 0.0;
+}
+
+// Must be reached by every invocation of the subgroup, out of range invocations pass visible = false
+void AppendVisibleDraw(bool visible, VkDrawIndexedIndirectCommand command)
+{
+	// Reserve the output slots for the whole subgroup with a single atomic
+	uvec4 visibleBallot = subgroupBallot(visible);
+	uint visibleCount = subgroupBallotBitCount(visibleBallot);
+
+	if (visibleCount == 0)
+		return;
+
+	uint firstSlot = 0;
+	if (subgroupElect())
+	{
+		firstSlot = atomicAdd(visibleDrawCount, visibleCount);
+	}
+	firstSlot = subgroupBroadcastFirst(firstSlot);
+
+	if (visible)
+	{
+		command.instanceCount = 1;
+		visibleDrawIndirectCommand[firstSlot + subgroupBallotExclusiveBitCount(visibleBallot)] = command;
+	}
+}